@@ -1,21 +1,132 @@
 #include <Servo.h>
 
+// Framed binary protocol, mirrors Serial/ServoProtocol.hpp on the host.
+// | 0xA5 | seq | opcode | length | payload | crc8 over seq..payload |
+namespace proto
+{
+    const uint8_t SYNC = 0xA5;
+    const uint8_t HEADER_SIZE = 4;
+    const uint8_t MAX_PAYLOAD = 32;
+    const uint8_t MAX_FRAME_SIZE = HEADER_SIZE + MAX_PAYLOAD + 1;
+    const unsigned long BAUDRATE = 115200;
+
+    const uint8_t OP_PING = 0x01;
+    const uint8_t OP_SET_ANGLE = 0x02;
+    const uint8_t OP_ACK = 0x80;
+
+    const uint8_t ACK_OK = 0;
+    const uint8_t ACK_UNKNOWN_OPCODE = 1;
+    const uint8_t ACK_BAD_PAYLOAD = 2;
+
+    uint8_t crc8(const uint8_t *data, uint8_t size)
+    {
+        uint8_t crc = 0;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            crc ^= data[i];
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+            }
+        }
+
+        return crc;
+    }
+
+    typedef void (*FrameHandler)(uint8_t seq, uint8_t opcode, const uint8_t *payload, uint8_t size);
+
+    // Fed one byte at a time from loop(), never waits for the rest of a frame.
+    // A frame failing the length or CRC check is searched again from the byte
+    // after its sync byte, so a real frame behind a false sync is not lost.
+    class Decoder
+    {
+    public:
+        void push(uint8_t byte, FrameHandler onFrame)
+        {
+            uint8_t input[MAX_FRAME_SIZE];
+            uint8_t count = 0, pos = 0;
+            input[count++] = byte;
+            while (pos < count)
+            {
+                const int8_t result = step(input[pos++]);
+                if (result > 0)
+                {
+                    onFrame(raw[1], raw[2], raw + HEADER_SIZE, raw[3]);
+                    rawSize = 0;
+                }
+                else if (result < 0)
+                {
+                    uint8_t rest[MAX_FRAME_SIZE];
+                    uint8_t restCount = 0;
+                    for (uint8_t i = 1; i < rawSize; i++) rest[restCount++] = raw[i];
+                    while (pos < count) rest[restCount++] = input[pos++];
+                    rawSize = 0;
+                    memcpy(input, rest, restCount);
+                    count = restCount;
+                    pos = 0;
+                }
+            }
+        }
+
+    private:
+        // 1 for a complete frame, -1 for a rejected one, 0 otherwise.
+        int8_t step(uint8_t byte)
+        {
+            if (rawSize == 0)
+            {
+                if (byte == SYNC) raw[rawSize++] = byte;
+                return 0;
+            }
+
+            raw[rawSize++] = byte;
+            if (rawSize == HEADER_SIZE && raw[3] > MAX_PAYLOAD) return -1;
+            if (rawSize < HEADER_SIZE || rawSize < HEADER_SIZE + raw[3] + 1) return 0;
+
+            return crc8(raw + 1, HEADER_SIZE - 1 + raw[3]) == raw[HEADER_SIZE + raw[3]] ? 1 : -1;
+        }
+
+        uint8_t raw[MAX_FRAME_SIZE];
+        uint8_t rawSize = 0;
+    };
+
+    void sendAck(uint8_t seq, uint8_t opcode, uint8_t status)
+    {
+        uint8_t frame[HEADER_SIZE + 3] = { SYNC, seq, OP_ACK, 2, opcode, status, 0 };
+        frame[HEADER_SIZE + 2] = crc8(frame + 1, HEADER_SIZE - 1 + 2);
+        Serial.write(frame, sizeof(frame));
+    }
+}
+
 const int MAIN_PIN = 3;
 Servo mainServo;
+proto::Decoder decoder;
 
-namespace util
+void handleFrame(uint8_t seq, uint8_t opcode, const uint8_t *payload, uint8_t size)
 {
-    int power(int base, int p)
+    switch (opcode)
     {
-        if (p == 0) return 1;
-
-        int res = base;
-        for (int i = 2; i <= p; i++)
+    case proto::OP_PING:
+        proto::sendAck(seq, opcode, proto::ACK_OK);
+        break;
+    case proto::OP_SET_ANGLE:
+    {
+        // Only one servo for now.
+        const uint16_t tenths = size == 3 ? payload[1] | (uint16_t)payload[2] << 8 : 0;
+        if (size != 3 || payload[0] != 0 || tenths > 1800)
         {
-            res *= base;
+            proto::sendAck(seq, opcode, proto::ACK_BAD_PAYLOAD);
+            break;
         }
 
-        return res;
+        // Pulse width resolves finer steps than write() in whole degrees.
+        mainServo.writeMicroseconds(map(tenths, 0, 1800, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH));
+        digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+        proto::sendAck(seq, opcode, proto::ACK_OK);
+        break;
+    }
+    default:
+        proto::sendAck(seq, opcode, proto::ACK_UNKNOWN_OPCODE);
+        break;
     }
 }
 
@@ -27,42 +138,15 @@ void setup()
     digitalWrite(LED_BUILTIN, LOW);
 
     mainServo.attach(MAIN_PIN);
-    Serial.begin(9600);
+    Serial.begin(proto::BAUDRATE);
 }
 
-void serialEvent()
+void loop()
 {
-    const String rotateCommand = "rotate";
-    while (Serial.available())
+    // Takes only what already arrived, the servo pulses are generated by a
+    // timer interrupt so nothing here has to wait.
+    while (Serial.available() > 0)
     {
-        const String readStr = Serial.readString();
-
-        if (readStr.substring(0, 6) == rotateCommand)
-        {
-            digitalWrite(LED_BUILTIN, HIGH);
-
-            int angle = 0;
-            String strAngle = readStr.substring(7, 10);
-            for (int i = 0; i < strAngle.length(); i++)
-            {
-                if (!isDigit(strAngle[i])) strAngle.remove(i);
-            }
-            Serial.println(strAngle);
-            Serial.println(strAngle.length());
-            for (int i = 0; i < strAngle.length(); i++)
-            {
-                if (isDigit(strAngle[i])) angle += (int)(strAngle[i] - '0') * util::power(10, strAngle.length() - 1 - i);
-            }
-            Serial.println(angle);
-
-            mainServo.write(angle);
-            delay(1000);
-            digitalWrite(LED_BUILTIN, LOW);
-        }
+        decoder.push((uint8_t)Serial.read(), handleFrame);
     }
 }
-
-void loop()
-{
-
-}
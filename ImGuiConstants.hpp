@@ -20,8 +20,35 @@ namespace imguic
         const float x = 0;
         const float y = watcher::h + 2;
         const float w = DEFAULT_WIDTH;
-        const float h = 180;
+        const float h = 236;
         const float btnW = 35;
         const float btnH = 20;
     }
+
+    // pipeline stages timing definitions
+    namespace pipeline
+    {
+        const float x = 0;
+        const float y = controller::y + controller::h + 2;
+        const float w = DEFAULT_WIDTH;
+        const float h = 184;
+    }
+
+    // motion gate definitions
+    namespace motion
+    {
+        const float x = 0;
+        const float y = pipeline::y + pipeline::h + 2;
+        const float w = DEFAULT_WIDTH;
+        const float h = 150;
+    }
+
+    // frame latency definitions
+    namespace latency
+    {
+        const float x = 0;
+        const float y = motion::y + motion::h + 2;
+        const float w = DEFAULT_WIDTH;
+        const float h = 180;
+    }
 }
\ No newline at end of file
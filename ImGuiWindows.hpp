@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -8,13 +9,17 @@
 
 #include <spdlog/spdlog.h>
 
-#include "Serial/SerialPort.hpp"
+#include "Serial/PortDiscovery.hpp"
+#include "Serial/SerialService.hpp"
+#include "Serial/ServoProtocol.hpp"
+#include "detect/MotionGate.hpp"
+#include "metrics/LatencyTrace.hpp"
+#include "pipeline/StageStats.hpp"
+#include "trace/Trace.hpp"
 #include "ImGuiConstants.hpp"
 
-void clearBuffer(char *buf, const size_t bsize);
-
 namespace wnd {
-    void showWatcherWindow(size_t humanCount) {
+    void showWatcherWindow(size_t humanCount, int &selectedStream, size_t streamsCount) {
         bool watcherShown = true;
         ImGui::SetNextWindowPos({ 0, 0 }, ImGuiCond_Always);
         ImGui::SetNextWindowSize({ imguic::watcher::w, imguic::watcher::h }, ImGuiCond_Always);
@@ -24,66 +29,160 @@ namespace wnd {
 
             ImGui::BeginChild("Output");
             ImGui::Text(infoLabel.c_str(), humanCount);
+            if (streamsCount > 1) {
+                ImGui::SameLine();
+                ImGui::SliderInt("stream", &selectedStream, 0, static_cast<int>(streamsCount) - 1);
+            }
             ImGui::EndChild();
         }
         ImGui::End();
     }
 
-    void showControllerWindow(std::unique_ptr<SerialPort> &port, char *commandBuf, size_t bufSize, const std::vector<std::string> &ports) {
+    void showControllerWindow(SerialService &serial, const std::vector<PortInfo> &ports,
+            std::atomic_bool &following, std::atomic<float> &servoAngle) {
         bool controllerShown = true;
-        static std::string connectedPortName = "";
 
         ImGui::SetNextWindowPos({ imguic::controller::x, imguic::controller::y }, ImGuiCond_Always);
         ImGui::SetNextWindowSize({ imguic::controller::w, imguic::controller::h }, ImGuiCond_Always);
         static std::string sendMessage;
+        const SerialServiceStatus status = serial.status();
         ImGui::Begin("controller", &controllerShown);
             ImGui::BeginChild("port", ImVec2(0, 64), true);
             if (ImGui::BeginMenu("Available COM ports")) {
                 for (const auto &availablePort: ports) {
-                    if (ImGui::MenuItem(availablePort.c_str())) {
-                        port = std::make_unique<SerialPort>(availablePort, SerialMode::ReadWrite);
-                        connectedPortName = availablePort;
+                    if (ImGui::MenuItem(describe(availablePort).c_str())) {
+                        spdlog::info("Connecting to {}", describe(availablePort));
+                        serial.connect(availablePort);
                     }
                 }
                 ImGui::EndMenu();
             }
-            const std::string connectionLabel = !connectedPortName.empty() ?
-                "Currently connected to " + connectedPortName + "." :
+            const std::string connectionLabel = !status.portName.empty() ?
+                "Currently connected to " + status.portName + "." :
+                !status.wantedPort.empty() ? "Waiting for " + status.wantedPort + " to come back." :
                 "No COM port connection.";
-            ImGui::Text(connectionLabel.c_str());
+            ImGui::Text("%s", connectionLabel.c_str());
+            if (!status.lastError.empty())
+                ImGui::Text("Last error: %s", status.lastError.c_str());
             ImGui::EndChild();
 
             ImGui::BeginChild("commands", ImVec2(0, 0), true);
-            ImGui::InputText("Type a command", commandBuf, bufSize);
-            if (ImGui::Button("Send", { imguic::controller::btnW, imguic::controller::btnH }))
-            {
-                try {
-                    if (connectedPortName.empty()) {
+            // Picked on the slider, sent only on "Send".
+            static float angle = servoAngle.load();
+            bool follow = following.load();
+            if (ImGui::Checkbox("follow the primary face", &follow)) following = follow;
+            if (follow) {
+                ImGui::Text("servo at %.1f deg", servoAngle.load());
+                angle = servoAngle.load();
+            }
+            else {
+                ImGui::SliderFloat("angle", &angle, 0.0f, 180.0f, "%.1f deg");
+                ImGui::SameLine();
+                if (ImGui::Button("Send", { imguic::controller::btnW, imguic::controller::btnH }))
+                {
+                    if (status.portName.empty()) {
                         sendMessage = "No COM port selected to send the command.";
                         spdlog::warn("No COM port selected to send the command");
                     }
                     else {
-                        port->open();
-                        sendMessage = "Trying to send command to COM port...";
-
-                        spdlog::info("Trying to send command to COM port");
-                        port->write(commandBuf, static_cast<uint32_t>(bufSize));
-                        spdlog::info("Wrote to COM port successfully.");
-                        sendMessage = "Wrote to COM port successfully.";
-                        port->close();
-                        clearBuffer(commandBuf, bufSize);
+                        if (serial.sendFrame(proto::setAngle(proto::nextSeq(), 0, angle))) {
+                            servoAngle = angle;
+                            sendMessage = "Command queued.";
+                        }
+                        else {
+                            sendMessage = "Command queue is full, try again.";
+                            spdlog::warn("Serial command queue is full");
+                        }
                     }
                 }
+            }
+            ImGui::Text("%s", sendMessage.c_str());
+            ImGui::Text("sent %llu, coalesced %llu, rejected %llu, failed %llu",
+                    static_cast<unsigned long long>(status.sent), static_cast<unsigned long long>(status.coalesced),
+                    static_cast<unsigned long long>(status.rejected), static_cast<unsigned long long>(status.failed));
+            ImGui::Text("capture to command %.1f ms recent, %.1f ms max", status.recentLatencyMs, status.maxLatencyMs);
+            ImGui::Text("round trip p50 %.1f p95 %.1f p99 %.1f ms, %llu acked, %llu unacked",
+                    status.roundTrip.p50Ms, status.roundTrip.p95Ms, status.roundTrip.p99Ms,
+                    static_cast<unsigned long long>(status.acked), static_cast<unsigned long long>(status.unacked));
+            ImGui::Text("link %.0f%% busy", 100.0 * status.linkUtilization);
+            ImGui::EndChild();
+        ImGui::End();
+    }
+
+    void showPipelineWindow(const std::vector<std::pair<std::string, const pipeline::StageStats *>> &stages,
+            const std::string &tracePath) {
+        bool pipelineShown = true;
+        ImGui::SetNextWindowPos({ imguic::pipeline::x, imguic::pipeline::y }, ImGuiCond_Always);
+        ImGui::SetNextWindowSize({ imguic::pipeline::w, imguic::pipeline::h }, ImGuiCond_Always);
+        ImGui::Begin("pipeline", &pipelineShown);
+        {
+            for (const auto &[name, stats] : stages) {
+                ImGui::Text("%-12s %8.2f ms recent %8.2f ms average %5.1f%% busy",
+                        name.c_str(), stats->recentMs(), stats->averageMs(), 100.0 * stats->utilization());
+            }
+
+            bool tracing = trace::isEnabled();
+            if (ImGui::Checkbox("record trace", &tracing)) trace::enable(tracing);
+            ImGui::SameLine();
+            if (ImGui::Button("write trace")) {
+                try {
+                    const size_t events = trace::writeChromeJson(tracePath);
+                    spdlog::info("Wrote {} trace events to {}", events, tracePath);
+                }
                 catch (const std::runtime_error &e) {
-                    spdlog::warn(e.what());
+                    spdlog::error(e.what());
                 }
             }
-            ImGui::Text(sendMessage.c_str());
-            ImGui::EndChild();
+            ImGui::SameLine();
+            ImGui::Text("to %s", tracePath.c_str());
+        }
         ImGui::End();
     }
-}
 
-void clearBuffer(char *buf, const size_t bsize) {
-    for (size_t i = 0; i < bsize; i++) buf[i] = 0;
-}
\ No newline at end of file
+    void showMotionGateWindow(detect::MotionGateSettings &settings,
+            const std::vector<std::unique_ptr<detect::MotionGate>> &gates) {
+        bool motionShown = true;
+        ImGui::SetNextWindowPos({ imguic::motion::x, imguic::motion::y }, ImGuiCond_Always);
+        ImGui::SetNextWindowSize({ imguic::motion::w, imguic::motion::h }, ImGuiCond_Always);
+        ImGui::Begin("motion gate", &motionShown);
+        {
+            uint64_t checked = 0, admitted = 0;
+            for (const auto &gate : gates) {
+                checked += gate->checked();
+                admitted += gate->admitted();
+            }
+            ImGui::Text("Detector ran on %llu of %llu checked frames (%.1f%%)",
+                    static_cast<unsigned long long>(admitted), static_cast<unsigned long long>(checked),
+                    checked ? 100.0 * admitted / checked : 0.0);
+            for (size_t id = 0; id < gates.size(); id++)
+                ImGui::Text("stream %u motion %5.2f%%", static_cast<unsigned>(id), 100.0f * gates[id]->energy());
+
+            // Percent in the UI, fraction in the settings.
+            float energyThreshold = 100.0f * settings.energyThreshold.load();
+            if (ImGui::SliderFloat("motion threshold, %", &energyThreshold, 0.0f, 20.0f, "%.2f"))
+                settings.energyThreshold = energyThreshold / 100.0f;
+            int pixelThreshold = settings.pixelThreshold.load();
+            if (ImGui::SliderInt("pixel threshold", &pixelThreshold, 1, 64))
+                settings.pixelThreshold = pixelThreshold;
+            int keepaliveMs = settings.keepaliveMs.load();
+            if (ImGui::SliderInt("keepalive, ms", &keepaliveMs, 0, 10000))
+                settings.keepaliveMs = keepaliveMs;
+        }
+        ImGui::End();
+    }
+
+    void showLatencyWindow(const std::vector<metrics::LatencyTrace::StageLatency> &stages) {
+        bool latencyShown = true;
+        ImGui::SetNextWindowPos({ imguic::latency::x, imguic::latency::y }, ImGuiCond_Always);
+        ImGui::SetNextWindowSize({ imguic::latency::w, imguic::latency::h }, ImGuiCond_Always);
+        ImGui::Begin("latency", &latencyShown);
+        {
+            ImGui::Text("%-12s %22s %14s", "", "since capture p50/p95/p99", "in stage p50");
+            for (const metrics::LatencyTrace::StageLatency &stage : stages) {
+                ImGui::Text("%-12s %6.1f %6.1f %6.1f ms %11.2f ms", stage.name.c_str(), stage.sinceCapture.p50Ms,
+                        stage.sinceCapture.p95Ms, stage.sinceCapture.p99Ms, stage.inStage.p50Ms);
+            }
+        }
+        ImGui::End();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+// Bounded lock-free queue for many producers and a single consumer.
+// Every cell carries a sequence number telling whose turn it is, so producers
+// only race for the tail index and never wait for each other or the consumer:
+// when the queue is full tryPush() fails right away.
+template <typename T>
+class MpscQueue
+{
+    struct Cell {
+        std::atomic_size_t sequence;
+        T value;
+    };
+public:
+    // Capacity is rounded up to a power of two.
+    explicit MpscQueue(size_t capacity)
+    {
+        if (capacity < 2u)
+            throw std::invalid_argument("Queue needs at least two cells.");
+
+        size_t rounded = 2u;
+        while (rounded < capacity) rounded <<= 1u;
+        mask_ = rounded - 1u;
+        cells_ = std::make_unique<Cell[]>(rounded);
+        for (size_t i = 0; i < rounded; i++)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    template <typename Fill>
+    bool tryEmplace(Fill &&fill)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[tail & mask_];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == tail) {
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    fill(cell.value);
+                    cell.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            // The consumer has not freed this cell yet.
+            else if (sequence < tail) return false;
+            else tail = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const T &value)
+    {
+        return this->tryEmplace([&value](T &cell) { cell = value; });
+    }
+
+    // Consumer side only.
+    bool tryPop(T &dst)
+    {
+        Cell &cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) return false;
+
+        dst = std::move(cell.value);
+        cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        head_++;
+
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic_size_t tail_ = 0;
+    alignas(64) size_t head_ = 0;
+};
@@ -0,0 +1,59 @@
+#include "PortDiscovery.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+std::string describe(const PortInfo &port)
+{
+    std::string label = port.path;
+    if (!port.description.empty()) label += " (" + port.description + ')';
+    if (port.vendorId != 0 || port.productId != 0) {
+        char ids[16];
+        std::snprintf(ids, sizeof(ids), " %04x:%04x", port.vendorId, port.productId);
+        label += ids;
+    }
+
+    return label;
+}
+
+bool sameDevice(const PortInfo &a, const PortInfo &b)
+{
+    if (!a.stableName.empty() && !b.stableName.empty()) return a.stableName == b.stableName;
+    if (!a.serialNumber.empty() && !b.serialNumber.empty())
+        return a.vendorId == b.vendorId && a.productId == b.productId && a.serialNumber == b.serialNumber;
+
+    return a.path == b.path;
+}
+
+std::vector<PortInfo> PortDiscovery::ports() const
+{
+    std::lock_guard lock(mutex_);
+
+    return ports_;
+}
+
+void PortDiscovery::onChange(ChangeHandler handler)
+{
+    std::lock_guard lock(mutex_);
+    handler_ = std::move(handler);
+}
+
+void PortDiscovery::refresh()
+{
+    std::vector<PortInfo> ports = enumerate();
+    ChangeHandler handler;
+    {
+        std::lock_guard lock(mutex_);
+        const bool same = std::equal(ports.cbegin(), ports.cend(), ports_.cbegin(), ports_.cend(),
+                [](const PortInfo &a, const PortInfo &b) {
+                    return a.path == b.path && a.stableName == b.stableName && a.vendorId == b.vendorId &&
+                            a.productId == b.productId && a.serialNumber == b.serialNumber;
+                });
+        if (same) return;
+
+        ports_ = ports;
+        version_.fetch_add(1, std::memory_order_acq_rel);
+        handler = handler_;
+    }
+    if (handler) handler(ports);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PortInfo {
+    // What SerialPort opens, /dev/ttyACM0 or COM3.
+    std::string path;
+    // Name which survives replugging, /dev/serial/by-id/... on Linux, if any.
+    std::string stableName;
+    // Product or driver name.
+    std::string description;
+    // USB ids, 0 if the port is not on USB or they are unknown.
+    uint16_t vendorId = 0;
+    uint16_t productId = 0;
+    std::string serialNumber;
+};
+
+// Menu label with the path, description and USB ids.
+std::string describe(const PortInfo &port);
+// True if both are the same device, which may be under another path after
+// replugging: by stable name, else by USB ids and serial number, else by path.
+bool sameDevice(const PortInfo &a, const PortInfo &b);
+
+// Keeps the list of serial ports up to date. Ports are enumerated once on
+// construction from what the OS already knows (sysfs on Linux, the
+// SERIALCOMM registry key on Windows), nothing is opened or probed. After
+// that a watcher thread enumerates again only when a device comes or goes.
+class PortDiscovery
+{
+public:
+    using ChangeHandler = std::function<void(const std::vector<PortInfo> &ports)>;
+
+    PortDiscovery();
+    PortDiscovery(const PortDiscovery &) = delete;
+    PortDiscovery &operator=(const PortDiscovery &) = delete;
+    ~PortDiscovery();
+
+    std::vector<PortInfo> ports() const;
+    // Bumped whenever the list changed.
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+    // Called on the watcher thread with the new list after every change.
+    void onChange(ChangeHandler handler);
+
+    // One shot enumeration, sorted by path.
+    static std::vector<PortInfo> enumerate();
+#ifndef _WIN32
+    // Same with sysfs and /dev looked up below root instead of /, for tests.
+    static std::vector<PortInfo> enumerate(const std::string &root);
+#endif
+
+private:
+    void watch();
+    void refresh();
+
+    mutable std::mutex mutex_;
+    std::vector<PortInfo> ports_;
+    ChangeHandler handler_;
+    std::atomic_uint64_t version_ = 0;
+#ifdef _WIN32
+    void *stopEvent_ = nullptr;
+#else
+    int stopFd_ = -1;
+#endif
+    std::thread thread_;
+};
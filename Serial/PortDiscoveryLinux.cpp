@@ -0,0 +1,156 @@
+#include "PortDiscovery.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    std::string readAttribute(const fs::path &file)
+    {
+        std::ifstream in(file);
+        std::string value;
+        std::getline(in, value);
+
+        return value;
+    }
+
+    uint16_t readHexAttribute(const fs::path &file)
+    {
+        try {
+            return static_cast<uint16_t>(std::stoul(readAttribute(file), nullptr, 16));
+        }
+        catch (const std::exception &) {
+            return 0;
+        }
+    }
+
+    // Device node the link points to, mapped to the link itself.
+    std::map<std::string, std::string> stableNames(const std::string &root)
+    {
+        std::map<std::string, std::string> names;
+        std::error_code error;
+        for (const auto &entry : fs::directory_iterator(root + "/dev/serial/by-id", error)) {
+            const fs::path target = fs::canonical(entry.path(), error);
+            if (!error) names[target.string()] = entry.path().string();
+        }
+
+        return names;
+    }
+
+    bool isPortNode(const char *name)
+    {
+        const std::string node = name;
+        return node.rfind("tty", 0) == 0 || node.rfind("rfcomm", 0) == 0;
+    }
+}
+
+PortDiscovery::PortDiscovery()
+: ports_(enumerate()), version_(1)
+{
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    thread_ = std::thread(&PortDiscovery::watch, this);
+}
+
+PortDiscovery::~PortDiscovery()
+{
+    const uint64_t one = 1;
+    if (stopFd_ >= 0 && ::write(stopFd_, &one, sizeof(one)) < 0) {}
+    if (thread_.joinable()) thread_.join();
+    if (stopFd_ >= 0) ::close(stopFd_);
+}
+
+std::vector<PortInfo> PortDiscovery::enumerate()
+{
+    return enumerate("");
+}
+
+std::vector<PortInfo> PortDiscovery::enumerate(const std::string &root)
+{
+    const std::map<std::string, std::string> byId = stableNames(root);
+    std::vector<PortInfo> ports;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(root + "/sys/class/tty", error)) {
+        // Virtual consoles and pseudo terminals have no device behind them.
+        const fs::path device = fs::canonical(entry.path() / "device", error);
+        if (error) continue;
+
+        const std::string name = entry.path().filename().string();
+        const std::string subsystem = fs::canonical(device / "subsystem", error).filename().string();
+        // The 8250 driver registers ttyS0..ttyS31 whether the UARTs exist or not.
+        if (subsystem == "platform" && name.rfind("ttyS", 0) == 0) continue;
+
+        PortInfo port;
+        port.path = root + "/dev/" + name;
+        if (!fs::exists(port.path, error)) continue;
+        if (const auto link = byId.find(port.path); link != byId.end()) port.stableName = link->second;
+
+        // USB attributes belong to the USB device a few levels above the tty.
+        std::string product;
+        fs::path dir = device;
+        for (int level = 0; level < 4 && dir.has_relative_path(); level++, dir = dir.parent_path()) {
+            if (!fs::exists(dir / "idVendor", error)) continue;
+
+            port.vendorId = readHexAttribute(dir / "idVendor");
+            port.productId = readHexAttribute(dir / "idProduct");
+            port.serialNumber = readAttribute(dir / "serial");
+            product = readAttribute(dir / "product");
+            break;
+        }
+        port.description = !product.empty() ? product : fs::canonical(device / "driver", error).filename().string();
+        ports.push_back(std::move(port));
+    }
+    // ttyUSB2 before ttyUSB10.
+    std::sort(ports.begin(), ports.end(), [](const PortInfo &a, const PortInfo &b) {
+        return a.path.size() != b.path.size() ? a.path.size() < b.path.size() : a.path < b.path;
+    });
+
+    return ports;
+}
+
+void PortDiscovery::watch()
+{
+    // Device nodes show up in /dev once udev has set them up, which is late
+    // enough for sysfs to be complete as well.
+    const int inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify >= 0 && inotify_add_watch(inotify, "/dev", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+        ::close(inotify);
+        return;
+    }
+
+    std::array<pollfd, 2> fds = {{ { stopFd_, POLLIN, 0 }, { inotify, POLLIN, 0 } }};
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    for (;;) {
+        // A device usually brings several nodes at once, rescan once it is quiet.
+        const int ready = poll(fds.data(), inotify >= 0 ? 2 : 1, changed ? 200 : -1);
+        if (ready < 0 && errno != EINTR) break;
+        if (fds[0].revents & POLLIN) break;
+        if (ready == 0 && changed) {
+            this->refresh();
+            changed = false;
+            continue;
+        }
+        if (!(fds[1].revents & POLLIN)) continue;
+
+        ssize_t n;
+        while ((n = ::read(inotify, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < n;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                if (event->len > 0 && isPortNode(event->name)) changed = true;
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+    }
+
+    if (inotify >= 0) ::close(inotify);
+}
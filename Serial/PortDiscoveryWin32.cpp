@@ -0,0 +1,82 @@
+#include "PortDiscovery.hpp"
+
+#include <algorithm>
+
+#include <Windows.h>
+
+namespace {
+    // Serial drivers register their ports under this key, it's what Device
+    // Manager shows and it's read without touching any device.
+    const char *SERIALCOMM_KEY = "HARDWARE\\DEVICEMAP\\SERIALCOMM";
+}
+
+PortDiscovery::PortDiscovery()
+: ports_(enumerate()), version_(1)
+{
+    stopEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    thread_ = std::thread(&PortDiscovery::watch, this);
+}
+
+PortDiscovery::~PortDiscovery()
+{
+    if (stopEvent_) SetEvent(stopEvent_);
+    if (thread_.joinable()) thread_.join();
+    if (stopEvent_) CloseHandle(stopEvent_);
+}
+
+std::vector<PortInfo> PortDiscovery::enumerate()
+{
+    std::vector<PortInfo> ports;
+    HKEY key;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, SERIALCOMM_KEY, 0, KEY_READ, &key) != ERROR_SUCCESS)
+        return ports;
+
+    for (DWORD index = 0;; index++) {
+        // Value name is the driver's device, e.g. \Device\USBSER000, the data the COM name.
+        char device[256];
+        DWORD deviceSize = sizeof(device);
+        BYTE com[64];
+        DWORD comSize = sizeof(com) - 1;
+        DWORD type = 0;
+        const LONG result = RegEnumValueA(key, index, device, &deviceSize, nullptr, &type, com, &comSize);
+        if (result == ERROR_NO_MORE_ITEMS) break;
+        if (result != ERROR_SUCCESS || type != REG_SZ) continue;
+
+        com[comSize] = 0;
+        PortInfo port;
+        port.path = reinterpret_cast<const char *>(com);
+        port.description = device;
+        const size_t slash = port.description.find_last_of('\\');
+        if (slash != std::string::npos) port.description.erase(0, slash + 1);
+        ports.push_back(std::move(port));
+    }
+    RegCloseKey(key);
+
+    // COM2 before COM10.
+    std::sort(ports.begin(), ports.end(), [](const PortInfo &a, const PortInfo &b) {
+        return a.path.size() != b.path.size() ? a.path.size() < b.path.size() : a.path < b.path;
+    });
+
+    return ports;
+}
+
+void PortDiscovery::watch()
+{
+    // SERIALCOMM itself disappears with the last port, so its parent is watched.
+    HKEY key;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DEVICEMAP", 0, KEY_NOTIFY, &key) != ERROR_SUCCESS) return;
+    HANDLE changed = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+
+    for (;;) {
+        if (RegNotifyChangeKeyValue(key, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+                changed, TRUE) != ERROR_SUCCESS)
+            break;
+
+        const HANDLE handles[2] = { stopEvent_, changed };
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) break;
+        this->refresh();
+    }
+
+    CloseHandle(changed);
+    RegCloseKey(key);
+}
@@ -0,0 +1,25 @@
+#include "SerialBaudLinux.hpp"
+
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+bool setCustomBaudrate(int fd, uint32_t baudrate)
+{
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0) return false;
+
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_ispeed = baudrate;
+    tio.c_ospeed = baudrate;
+
+    return ioctl(fd, TCSETS2, &tio) == 0;
+}
+
+uint32_t currentBaudrate(int fd)
+{
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0) return 0;
+
+    return tio.c_ospeed;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Sets a baud rate termios has no Bxxx constant for. Lives in its own
+// translation unit because the kernel headers it needs clash with <termios.h>.
+bool setCustomBaudrate(int fd, uint32_t baudrate);
+// Output baud rate of the terminal behind fd, 0 if it cannot be read.
+uint32_t currentBaudrate(int fd);
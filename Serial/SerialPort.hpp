@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -13,6 +15,14 @@ enum class SerialMode : unsigned long {
     ReadWrite = Read | Write
 };
 
+#else
+
+enum class SerialMode : unsigned long {
+    Read = 1,
+    Write = 2,
+    ReadWrite = Read | Write
+};
+
 #endif
 
 const size_t MAX_DATA_SIZE = 128;
@@ -25,17 +35,48 @@ class SerialPort
 {
 public:
     SerialPort(const std::string &portName, SerialMode mode = SerialMode::ReadWrite, uint32_t baudrate = 9600u);
+    SerialPort(const SerialPort &) = delete;
+    SerialPort &operator=(const SerialPort &) = delete;
+    ~SerialPort();
 
     void open();
+    // Another thread may close the port while it waits in readSome() or
+    // write(), the read returns no data and the write throws.
     void close();
+    bool isOpen() const;
+    // read() returns no data once readMs passed without any byte arriving,
+    // write() throws if the data could not be sent within writeMs.
+    // Applied on the next open() on Windows.
+    void setTimeouts(uint32_t readMs, uint32_t writeMs);
     SerialReadData read();
+    // Like read() but straight into dst, returns the number of bytes read.
+    // One thread may read while another one writes.
+    size_t readSome(char *dst, size_t capacity);
     void write(const char *data, uint32_t count);
-    static std::vector<std::string> queryAvailable();
 
 private:
     std::string name;
-    uint32_t baudrate;
     SerialMode mode;
-    HANDLE m_hCom;
+    uint32_t baudrate;
+    uint32_t readTimeoutMs = 50u;
+    uint32_t writeTimeoutMs = 50u;
+    std::atomic_bool m_closing = false;
+    // Reads and writes in progress, close() waits for them to leave.
+    std::atomic_int m_busy = 0;
+#ifdef _WIN32
+    HANDLE m_hCom = INVALID_HANDLE_VALUE;
     DCB m_serialParams;
+    // Overlapped reads and writes each wait on their own event.
+    HANDLE m_readEvent = nullptr;
+    HANDLE m_writeEvent = nullptr;
+#else
+    int m_fd = -1;
+    // Edge triggered, the port is only waited for after it returned EAGAIN.
+    // One instance per direction, so a reader and a writer thread never
+    // consume each other's wake ups.
+    int m_epollIn = -1;
+    int m_epollOut = -1;
+    // Signalled by close() and watched by both epoll instances.
+    int m_wake = -1;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "SerialPort.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "SerialBaudLinux.hpp"
+
+namespace {
+    speed_t standardSpeed(uint32_t baudrate)
+    {
+        switch (baudrate) {
+            case 1200: return B1200;
+            case 2400: return B2400;
+            case 4800: return B4800;
+            case 9600: return B9600;
+            case 19200: return B19200;
+            case 38400: return B38400;
+            case 57600: return B57600;
+            case 115200: return B115200;
+            case 230400: return B230400;
+            case 460800: return B460800;
+            case 500000: return B500000;
+            case 576000: return B576000;
+            case 921600: return B921600;
+            case 1000000: return B1000000;
+            case 2000000: return B2000000;
+            default: return B0;
+        }
+    }
+
+    std::runtime_error systemError(const std::string &what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    int watch(int fd, uint32_t events, int wake)
+    {
+        const int epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll < 0)
+            throw systemError("Could not create epoll instance");
+
+        epoll_event event {};
+        event.events = events | EPOLLET;
+        event.data.fd = fd;
+        // Level triggered, once close() signalled it every wait ends at once.
+        epoll_event wakeEvent {};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.fd = wake;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, wake, &wakeEvent) != 0) {
+            ::close(epoll);
+            throw systemError("Could not watch serial port");
+        }
+
+        return epoll;
+    }
+
+    // Keeps close() from releasing the descriptors while a read or write
+    // still uses them.
+    class BusyGuard
+    {
+    public:
+        explicit BusyGuard(std::atomic_int &busy) : busy(busy) { busy.fetch_add(1); }
+        ~BusyGuard() { busy.fetch_sub(1); }
+        BusyGuard(const BusyGuard &) = delete;
+        BusyGuard &operator=(const BusyGuard &) = delete;
+
+    private:
+        std::atomic_int &busy;
+    };
+
+    // Sleeps until the edge triggered epoll reports one of the events, close()
+    // signals wake or the deadline passes. Returns false on timeout.
+    bool waitFor(int epoll, int wake, uint32_t events, Clock::time_point deadline)
+    {
+        for (;;) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            // Rounds up, so the wait never ends a little before the deadline.
+            const int timeout = left.count() > 0 ? static_cast<int>(left.count()) + 1 : 0;
+
+            epoll_event event;
+            const int ready = epoll_wait(epoll, &event, 1, timeout);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                throw systemError("Waiting for serial port failed");
+            }
+            if (ready == 0) return false;
+            // The caller finds the port closing and gives up.
+            if (event.data.fd == wake) return true;
+            if (event.events & (events | EPOLLERR | EPOLLHUP)) return true;
+            // Not one of the events waited for, keep waiting.
+            if (Clock::now() >= deadline) return false;
+        }
+    }
+}
+
+SerialPort::SerialPort(const std::string &portName, SerialMode mode, uint32_t baudrate)
+: name(portName), mode(mode), baudrate(baudrate) {}
+
+SerialPort::~SerialPort()
+{
+    if (m_epollIn >= 0) ::close(m_epollIn);
+    if (m_epollOut >= 0) ::close(m_epollOut);
+    if (m_wake >= 0) ::close(m_wake);
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+void SerialPort::open()
+{
+    if (m_fd >= 0) return;
+
+    const int access = mode == SerialMode::Read ? O_RDONLY : mode == SerialMode::Write ? O_WRONLY : O_RDWR;
+    m_fd = ::open(name.c_str(), access | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+        throw std::runtime_error("Cannot connect to serial port [" + name + ']');
+
+    try {
+        termios tty;
+        if (tcgetattr(m_fd, &tty) != 0)
+            throw systemError("Could not retrieve serial port status");
+
+        // Raw 8N1 without flow control. VMIN 1 makes a non-blocking read report
+        // EAGAIN when there is no data, with VMIN 0 it would return 0 like on EOF.
+        cfmakeraw(&tty);
+        tty.c_cflag |= CLOCAL | CREAD;
+        tty.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+
+        const speed_t speed = standardSpeed(baudrate);
+        if (speed != B0) {
+            cfsetispeed(&tty, speed);
+            cfsetospeed(&tty, speed);
+        }
+        if (tcsetattr(m_fd, TCSANOW, &tty) != 0)
+            throw systemError("Could not configure serial port");
+        if (speed == B0 && !setCustomBaudrate(m_fd, baudrate))
+            throw systemError("Could not set baud rate " + std::to_string(baudrate));
+        tcflush(m_fd, TCIOFLUSH);
+
+        m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_wake < 0)
+            throw systemError("Could not create serial port wake up event");
+        m_epollIn = watch(m_fd, EPOLLIN, m_wake);
+        m_epollOut = watch(m_fd, EPOLLOUT, m_wake);
+    }
+    catch (...) {
+        this->close();
+        throw;
+    }
+}
+
+void SerialPort::close()
+{
+    // Wakes a read or write waiting on another thread and lets it return
+    // before its descriptors go away.
+    m_closing.store(true);
+    if (m_wake >= 0) eventfd_write(m_wake, 1);
+    while (m_busy.load() > 0) std::this_thread::yield();
+
+    if (m_wake >= 0) ::close(m_wake);
+    m_wake = -1;
+    if (m_epollIn >= 0) ::close(m_epollIn);
+    m_epollIn = -1;
+    if (m_epollOut >= 0) ::close(m_epollOut);
+    m_epollOut = -1;
+    int closed = 0;
+    if (m_fd >= 0) closed = ::close(m_fd);
+    m_fd = -1;
+    m_closing.store(false);
+    if (closed != 0) throw std::runtime_error("Could not close the serial port.");
+}
+
+bool SerialPort::isOpen() const { return m_fd >= 0; }
+
+void SerialPort::setTimeouts(uint32_t readMs, uint32_t writeMs)
+{
+    readTimeoutMs = readMs;
+    writeTimeoutMs = writeMs;
+}
+
+void SerialPort::write(const char *data, uint32_t count)
+{
+    const BusyGuard busy(m_busy);
+    if (m_fd < 0 || m_closing.load()) throw std::runtime_error("Could not write to serial port, it is not open.");
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(writeTimeoutMs);
+    uint32_t written = 0;
+    while (written < count) {
+        if (m_closing.load()) throw std::runtime_error("Serial port was closed while writing.");
+        const ssize_t n = ::write(m_fd, data + written, count - written);
+        if (n > 0) {
+            written += static_cast<uint32_t>(n);
+        }
+        else if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (n < 0 && errno != EAGAIN) {
+            throw systemError("Could not write to serial port");
+        }
+        else if (!waitFor(m_epollOut, m_wake, EPOLLOUT, deadline)) {
+            throw std::runtime_error("Timed out writing to serial port.");
+        }
+    }
+}
+
+SerialReadData SerialPort::read()
+{
+    SerialReadData readData;
+    readData.actualSize = this->readSome(readData.data, MAX_DATA_SIZE);
+
+    return readData;
+}
+
+size_t SerialPort::readSome(char *dst, size_t capacity)
+{
+    const BusyGuard busy(m_busy);
+    if (m_fd < 0 || m_closing.load()) throw std::runtime_error("Could not read from the serial port, it is not open.");
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(readTimeoutMs);
+    for (;;) {
+        // Closed by another thread meanwhile, same as a timeout.
+        if (m_closing.load()) return 0;
+        const ssize_t n = ::read(m_fd, dst, capacity);
+        if (n > 0) return static_cast<size_t>(n);
+        // End of file, the device is gone or the other side of a pseudo
+        // terminal has hung up. Reading again would return at once forever.
+        if (n == 0) throw std::runtime_error("Serial port [" + name + "] has hung up.");
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN)
+            throw systemError("Could not read from the serial port");
+        if (!waitFor(m_epollIn, m_wake, EPOLLIN, deadline)) return 0;
+    }
+}
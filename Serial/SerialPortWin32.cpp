@@ -0,0 +1,166 @@
+#include "SerialPort.hpp"
+
+#include <stdexcept>
+#include <thread>
+
+namespace {
+	// Keeps close() from releasing the handles while a read or write still
+	// uses them.
+	class BusyGuard
+	{
+	public:
+		explicit BusyGuard(std::atomic_int &busy) : busy(busy) { busy.fetch_add(1); }
+		~BusyGuard() { busy.fetch_sub(1); }
+		BusyGuard(const BusyGuard &) = delete;
+		BusyGuard &operator=(const BusyGuard &) = delete;
+
+	private:
+		std::atomic_int &busy;
+	};
+
+	// Waits for an overlapped ReadFile or WriteFile, the driver ends it when
+	// its COMMTIMEOUTS say so. Returns false if it failed or was cancelled,
+	// GetLastError() tells which.
+	bool complete(HANDLE handle, OVERLAPPED &overlapped, BOOL started, DWORD &transferred)
+	{
+		if (!started && GetLastError() != ERROR_IO_PENDING) return false;
+
+		return GetOverlappedResult(handle, &overlapped, &transferred, TRUE) != FALSE;
+	}
+}
+
+SerialPort::SerialPort(const std::string &portName, SerialMode mode, uint32_t baudrate)
+: name(portName), mode(mode), baudrate(baudrate) {}
+
+void SerialPort::open()
+{
+	// Overlapped, so a read waiting in the driver never holds up a write from
+	// another thread and both wait on events instead of polling.
+	m_hCom = CreateFileA(name.c_str(), static_cast<unsigned long>(mode), 0, nullptr, OPEN_EXISTING,
+		FILE_FLAG_OVERLAPPED, nullptr);
+
+	if (INVALID_HANDLE_VALUE == m_hCom)
+            throw std::runtime_error("Cannot connect to serial port [" + name + ']');
+
+	m_readEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	m_writeEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	if (!m_readEvent || !m_writeEvent)
+	{
+		this->close();
+		throw std::runtime_error("Could not create serial port events.");
+	}
+
+	DCB m_serialParams { 0 };
+	m_serialParams.DCBlength = sizeof(m_serialParams);
+
+	const bool currComStatusRetrieved = GetCommState(m_hCom, &m_serialParams);
+
+	if (!currComStatusRetrieved)
+	{
+		this->close();
+		throw std::runtime_error("Could not retrieve serial port status.");
+	}
+
+	m_serialParams.BaudRate = baudrate;
+	m_serialParams.fBinary = true;
+	m_serialParams.fParity = true;
+	m_serialParams.StopBits = ONESTOPBIT;
+	m_serialParams.Parity = PARITY_NONE;
+
+	SetCommState(m_hCom, &m_serialParams);
+
+	// With both read values at MAXDWORD a read returns as soon as a byte is
+	// there, or with nothing once the constant passed, see COMMTIMEOUTS. A zero
+	// read timeout returns at once instead.
+	COMMTIMEOUTS timeouts = { 0 };
+	timeouts.ReadIntervalTimeout = MAXDWORD;
+	timeouts.ReadTotalTimeoutMultiplier = readTimeoutMs > 0 ? MAXDWORD : 0;
+	timeouts.ReadTotalTimeoutConstant = readTimeoutMs < MAXDWORD ? readTimeoutMs : MAXDWORD - 1;
+	timeouts.WriteTotalTimeoutConstant = writeTimeoutMs;
+	timeouts.WriteTotalTimeoutMultiplier = 10;
+
+	SetCommTimeouts(m_hCom, &timeouts);
+}
+
+void SerialPort::close()
+{
+	// Cancels a read or write waiting on another thread and lets it return
+	// before its handles go away. Cancelled again in case one just started.
+	m_closing.store(true);
+	while (m_busy.load() > 0)
+	{
+		if (INVALID_HANDLE_VALUE != m_hCom) CancelIoEx(m_hCom, nullptr);
+		std::this_thread::yield();
+	}
+
+	if (m_readEvent) CloseHandle(m_readEvent);
+	m_readEvent = nullptr;
+	if (m_writeEvent) CloseHandle(m_writeEvent);
+	m_writeEvent = nullptr;
+	bool isClosed = true;
+	if (INVALID_HANDLE_VALUE != m_hCom) isClosed = CloseHandle(m_hCom);
+	m_hCom = INVALID_HANDLE_VALUE;
+	m_closing.store(false);
+	if (!isClosed) throw std::runtime_error("Could not close the serial port.");
+}
+
+SerialPort::~SerialPort()
+{
+	if (m_readEvent) CloseHandle(m_readEvent);
+	if (m_writeEvent) CloseHandle(m_writeEvent);
+	if (INVALID_HANDLE_VALUE != m_hCom) CloseHandle(m_hCom);
+}
+
+bool SerialPort::isOpen() const { return INVALID_HANDLE_VALUE != m_hCom; }
+
+void SerialPort::setTimeouts(uint32_t readMs, uint32_t writeMs)
+{
+	readTimeoutMs = readMs;
+	writeTimeoutMs = writeMs;
+}
+
+void SerialPort::write(const char *data, uint32_t count)
+{
+	const BusyGuard busy(m_busy);
+	if (INVALID_HANDLE_VALUE == m_hCom || m_closing.load())
+		throw std::runtime_error("Could not write to serial port, it is not open.");
+
+	OVERLAPPED overlapped = { 0 };
+	overlapped.hEvent = m_writeEvent;
+	DWORD bytesWritten = 0;
+	const BOOL started = WriteFile(m_hCom, data, count, nullptr, &overlapped);
+	if (!complete(m_hCom, overlapped, started, bytesWritten))
+	{
+		if (GetLastError() == ERROR_OPERATION_ABORTED)
+			throw std::runtime_error("Serial port was closed while writing.");
+		throw std::runtime_error("Could not write to serial port.");
+	}
+	if (bytesWritten < count) throw std::runtime_error("Timed out writing to serial port.");
+}
+
+SerialReadData SerialPort::read()
+{
+    SerialReadData readData;
+    readData.actualSize = this->readSome(readData.data, MAX_DATA_SIZE);
+
+    return readData;
+}
+
+size_t SerialPort::readSome(char *dst, size_t capacity)
+{
+    const BusyGuard busy(m_busy);
+    if (INVALID_HANDLE_VALUE == m_hCom || m_closing.load())
+        throw std::runtime_error("Could not read from the serial port, it is not open.");
+
+    // The driver completes the read on the first byte or after readMs, the
+    // thread sleeps on the event meanwhile.
+    OVERLAPPED overlapped = { 0 };
+    overlapped.hEvent = m_readEvent;
+    DWORD bytesRead = 0;
+    const BOOL started = ReadFile(m_hCom, dst, static_cast<DWORD>(capacity), nullptr, &overlapped);
+    if (complete(m_hCom, overlapped, started, bytesRead)) return static_cast<size_t>(bytesRead);
+    // Cancelled by close() on another thread, same as a timeout.
+    if (GetLastError() == ERROR_OPERATION_ABORTED) return 0;
+
+    throw std::runtime_error("Could not read from the serial port.");
+}
@@ -0,0 +1,66 @@
+#include "SerialReader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+SerialReader::SerialReader(SerialPort &port, FrameHandler onFrame, ErrorHandler onError)
+: port_(port), onFrame_(std::move(onFrame)), onError_(std::move(onError))
+{
+    thread_ = std::thread(&SerialReader::loop, this);
+}
+
+SerialReader::~SerialReader()
+{
+    stopping_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+}
+
+void SerialReader::loop()
+{
+    const size_t mask = RING_SIZE - 1u;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Parsing keeps at most one incomplete frame, the rest is always free.
+        const size_t free = RING_SIZE - (tail_ - head_);
+        const size_t contiguous = std::min(free, RING_SIZE - (tail_ & mask));
+
+        size_t n = 0;
+        try {
+            n = port_.readSome(reinterpret_cast<char *>(ring_.data() + (tail_ & mask)), contiguous);
+        }
+        catch (const std::runtime_error &e) {
+            onError_(e.what());
+            break;
+        }
+        if (n == 0) continue;
+
+        tail_ += n;
+        bytesRead_.fetch_add(n, std::memory_order_relaxed);
+        this->parse(Clock::now());
+    }
+}
+
+void SerialReader::parse(Clock::time_point received)
+{
+    const size_t mask = RING_SIZE - 1u;
+    while (head_ != tail_) {
+        if (ring_[head_ & mask] != proto::SYNC) {
+            head_++;
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const proto::FrameCheck check = proto::checkFrame(ring_.data(), mask, head_, tail_ - head_);
+        if (check == proto::FrameCheck::Incomplete) return;
+        if (check == proto::FrameCheck::Invalid) {
+            // A false sync byte, look again right after it.
+            head_++;
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const proto::FrameView frame(ring_.data(), mask, head_);
+        onFrame_(frame, received);
+        head_ += frame.frameSize();
+        frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "SerialPort.hpp"
+#include "ServoProtocol.hpp"
+
+// Reads the device's frames on its own thread for as long as it lives.
+// Bytes go straight from the port into a ring buffer and frames are checked
+// and handed out where they lie, see proto::FrameView. The port must outlive
+// the reader, writes from another thread may go on meanwhile.
+class SerialReader
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    // Called on the reader thread, the view is only valid during the call.
+    using FrameHandler = std::function<void(const proto::FrameView &frame, Clock::time_point received)>;
+    using ErrorHandler = std::function<void(const std::string &error)>;
+
+    SerialReader(SerialPort &port, FrameHandler onFrame, ErrorHandler onError);
+    SerialReader(const SerialReader &) = delete;
+    SerialReader &operator=(const SerialReader &) = delete;
+    // Waits for the read in progress, at most the port's read timeout.
+    ~SerialReader();
+
+    uint64_t bytesRead() const { return bytesRead_.load(std::memory_order_relaxed); }
+    uint64_t frames() const { return frames_.load(std::memory_order_relaxed); }
+    // Bytes skipped while looking for a valid frame.
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    void loop();
+    void parse(Clock::time_point received);
+
+    static const size_t RING_SIZE = 4096u;
+
+    SerialPort &port_;
+    const FrameHandler onFrame_;
+    const ErrorHandler onError_;
+    std::array<uint8_t, RING_SIZE> ring_{};
+    // Free running positions, masked when indexing. Reader thread only.
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    std::atomic_bool stopping_ = false;
+    std::atomic_uint64_t bytesRead_ = 0;
+    std::atomic_uint64_t frames_ = 0;
+    std::atomic_uint64_t skipped_ = 0;
+    std::thread thread_;
+};
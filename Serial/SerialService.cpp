@@ -0,0 +1,315 @@
+#include "SerialService.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // True if a later write in the same run of writes carries the same key.
+    bool isSuperseded(const std::vector<SerialCommand> &batch, size_t index)
+    {
+        const uint32_t key = batch[index].key;
+        if (key == 0u) return false;
+
+        for (size_t i = index + 1; i < batch.size(); i++) {
+            // Never move a write across a reconnect.
+            if (batch[i].kind != SerialCommand::Kind::Write) return false;
+            if (batch[i].key == key) return true;
+        }
+
+        return false;
+    }
+}
+
+SerialService::SerialService(size_t queueCapacity, uint32_t baudrate)
+: queue_(queueCapacity), baudrate_(baudrate)
+{
+    thread_ = std::thread(&SerialService::loop, this);
+}
+
+SerialService::~SerialService()
+{
+    this->stop();
+}
+
+bool SerialService::connect(const std::string &portName)
+{
+    PortInfo port;
+    port.path = portName;
+
+    return this->connect(port);
+}
+
+bool SerialService::connect(const PortInfo &port)
+{
+    {
+        std::lock_guard lock(statusMutex_);
+        wantedDevice_ = port;
+    }
+    return this->enqueue(SerialCommand::Kind::Open, port.path.data(), port.path.size(), 0u);
+}
+
+bool SerialService::disconnect()
+{
+    {
+        std::lock_guard lock(statusMutex_);
+        wantedDevice_ = PortInfo();
+    }
+    return this->enqueue(SerialCommand::Kind::Close, nullptr, 0u, 0u);
+}
+
+bool SerialService::send(const char *data, size_t size, uint32_t key, std::chrono::steady_clock::time_point origin)
+{
+    return this->enqueue(SerialCommand::Kind::Write, data, size, key, origin);
+}
+
+bool SerialService::send(const std::string &data, uint32_t key)
+{
+    return this->send(data.data(), data.size(), key);
+}
+
+bool SerialService::sendFrame(const proto::Frame &frame, std::chrono::steady_clock::time_point origin)
+{
+    uint8_t encoded[proto::MAX_FRAME_SIZE];
+    const size_t size = proto::encode(frame, encoded);
+
+    return this->enqueue(SerialCommand::Kind::Write, reinterpret_cast<const char *>(encoded), size,
+            proto::coalescingKey(frame), origin, frame.seq);
+}
+
+bool SerialService::enqueue(SerialCommand::Kind kind, const char *data, size_t size, uint32_t key,
+        std::chrono::steady_clock::time_point origin, int16_t seq)
+{
+    if (size > SERIAL_COMMAND_SIZE)
+        throw std::length_error("Serial command is longer than " + std::to_string(SERIAL_COMMAND_SIZE) + " bytes.");
+    if (stopping_.load(std::memory_order_acquire)) return false;
+
+    const bool pushed = queue_.tryEmplace([&](SerialCommand &command) {
+        command.kind = kind;
+        command.key = key;
+        command.size = static_cast<uint32_t>(size);
+        command.origin = origin;
+        command.seq = seq;
+        if (size) std::memcpy(command.data.data(), data, size);
+    });
+    if (!pushed) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+
+    return true;
+}
+
+void SerialService::stop()
+{
+    if (stopping_.exchange(true, std::memory_order_acq_rel)) {
+        if (thread_.joinable()) thread_.join();
+        return;
+    }
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+SerialServiceStatus SerialService::status() const
+{
+    SerialServiceStatus status;
+    {
+        std::lock_guard lock(statusMutex_);
+        status.portName = portName_;
+        status.wantedPort = wantedDevice_.path;
+        status.wantedDevice = wantedDevice_;
+        status.lastError = lastError_;
+    }
+    status.sent = sent_.load(std::memory_order_relaxed);
+    status.coalesced = coalesced_.load(std::memory_order_relaxed);
+    status.rejected = rejected_.load(std::memory_order_relaxed);
+    status.failed = failed_.load(std::memory_order_relaxed);
+    status.recentLatencyMs = recentLatencyMs_.load(std::memory_order_relaxed);
+    status.maxLatencyMs = maxLatencyMs_.load(std::memory_order_relaxed);
+    status.acked = acked_.load(std::memory_order_relaxed);
+    status.strayAcks = strayAcks_.load(std::memory_order_relaxed);
+    status.refused = refused_.load(std::memory_order_relaxed);
+    status.unacked = unacked_.load(std::memory_order_relaxed);
+    status.roundTrip = metrics::summarize(roundTrip_);
+    status.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(statusMutex_);
+    const std::chrono::duration<double> sinceSample = now - rateSampledAt_;
+    if (sinceSample.count() >= 1.0) {
+        // 8N1 takes ten bits on the wire for every byte.
+        const double capacity = baudrate_ / 10.0 * sinceSample.count();
+        linkUtilization_ = rateSampledAt_ == std::chrono::steady_clock::time_point()
+                ? 0.0 : static_cast<double>(status.bytesWritten - rateSampledBytes_) / capacity;
+        rateSampledAt_ = now;
+        rateSampledBytes_ = status.bytesWritten;
+    }
+    status.linkUtilization = linkUtilization_;
+
+    return status;
+}
+
+void SerialService::loop()
+{
+    std::vector<SerialCommand> batch;
+    batch.reserve(queue_.capacity());
+    SerialCommand command;
+
+    for (;;) {
+        const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+
+        // Everything queued while the previous batch was being written is
+        // taken at once, so superseded writes can be dropped.
+        batch.clear();
+        while (batch.size() < queue_.capacity() && queue_.tryPop(command))
+            batch.push_back(command);
+
+        if (!batch.empty()) {
+            this->execute(batch);
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) break;
+
+        epoch_.wait(epoch, std::memory_order_acquire);
+    }
+
+    this->closePort();
+}
+
+void SerialService::execute(const std::vector<SerialCommand> &batch)
+{
+    for (size_t i = 0; i < batch.size(); i++) {
+        const SerialCommand &command = batch[i];
+        switch (command.kind) {
+            case SerialCommand::Kind::Open:
+                this->openPort(std::string(command.data.data(), command.size));
+                break;
+            case SerialCommand::Kind::Close: {
+                // A close naming a port comes from its reader after a hang up and
+                // must not close a port opened meanwhile.
+                const std::string portName(command.data.data(), command.size);
+                bool isOpenPort = portName.empty();
+                if (!isOpenPort) {
+                    std::lock_guard lock(statusMutex_);
+                    isOpenPort = portName == portName_;
+                }
+                if (isOpenPort) this->closePort();
+                break;
+            }
+            case SerialCommand::Kind::Write:
+                if (isSuperseded(batch, i)) {
+                    coalesced_.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+                if (!port_) {
+                    this->fail("No serial port connected to send the command.");
+                    break;
+                }
+                try {
+                    // Stored before writing, the ack may be read before write() returns.
+                    if (command.seq >= 0) {
+                        const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+                        if (sentAt_[command.seq].exchange(now, std::memory_order_acq_rel) != 0)
+                            unacked_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    port_->write(command.data.data(), command.size);
+                    sent_.fetch_add(1, std::memory_order_relaxed);
+                    bytesWritten_.fetch_add(command.size, std::memory_order_relaxed);
+                    if (command.origin != std::chrono::steady_clock::time_point())
+                        this->recordLatency(std::chrono::steady_clock::now() - command.origin);
+                }
+                catch (const std::runtime_error &e) {
+                    if (command.seq >= 0) sentAt_[command.seq].store(0, std::memory_order_release);
+                    this->fail(e.what());
+                }
+                break;
+        }
+    }
+}
+
+void SerialService::openPort(const std::string &portName)
+{
+    this->closePort();
+    try {
+        auto port = std::make_unique<SerialPort>(portName, SerialMode::ReadWrite, baudrate_);
+        // The read timeout bounds how long closing waits for the reader.
+        port->setTimeouts(20u, 50u);
+        port->open();
+        port_ = std::move(port);
+        for (std::atomic_int64_t &sentAt : sentAt_) sentAt.store(0, std::memory_order_relaxed);
+        reader_ = std::make_unique<SerialReader>(*port_,
+                [this](const proto::FrameView &frame, std::chrono::steady_clock::time_point received) {
+                    this->onFrame(frame, received);
+                },
+                [this, portName](const std::string &error) {
+                    // E.g. the adapter was unplugged, the port is closed so it can be
+                    // reopened once it is back.
+                    this->fail(error);
+                    this->enqueue(SerialCommand::Kind::Close, portName.data(), portName.size(), 0u);
+                });
+        connected_.store(true, std::memory_order_release);
+
+        std::lock_guard lock(statusMutex_);
+        portName_ = portName;
+        lastError_.clear();
+    }
+    catch (const std::runtime_error &e) {
+        this->fail(e.what());
+    }
+}
+
+void SerialService::closePort()
+{
+    if (!port_) return;
+
+    reader_.reset();
+    try {
+        port_->close();
+    }
+    catch (const std::runtime_error &e) {
+        this->fail(e.what());
+    }
+    port_.reset();
+    connected_.store(false, std::memory_order_release);
+
+    std::lock_guard lock(statusMutex_);
+    portName_.clear();
+}
+
+void SerialService::recordLatency(std::chrono::steady_clock::duration latency)
+{
+    // Only the I/O thread writes, load and store are enough.
+    const double ms = std::chrono::duration<double, std::milli>(latency).count();
+    const double recent = recentLatencyMs_.load(std::memory_order_relaxed);
+    recentLatencyMs_.store(recent == 0.0 ? ms : 0.9 * recent + 0.1 * ms, std::memory_order_relaxed);
+    if (ms > maxLatencyMs_.load(std::memory_order_relaxed)) maxLatencyMs_.store(ms, std::memory_order_relaxed);
+}
+
+void SerialService::onFrame(const proto::FrameView &frame, std::chrono::steady_clock::time_point received)
+{
+    if (frame.opcode() != proto::Opcode::Ack || frame.size() < 2) return;
+
+    const int64_t sentAt = sentAt_[frame.seq()].exchange(0, std::memory_order_acq_rel);
+    if (sentAt == 0) {
+        strayAcks_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    roundTrip_.record(received - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(sentAt)));
+    acked_.fetch_add(1, std::memory_order_relaxed);
+    if (static_cast<proto::AckStatus>(frame.payload(1)) != proto::AckStatus::Ok)
+        refused_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SerialService::fail(const std::string &error)
+{
+    failed_.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard lock(statusMutex_);
+    lastError_ = error;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MpscQueue.hpp"
+#include "PortDiscovery.hpp"
+#include "SerialPort.hpp"
+#include "SerialReader.hpp"
+#include "ServoProtocol.hpp"
+#include "metrics/Histogram.hpp"
+
+const size_t SERIAL_COMMAND_SIZE = 256;
+
+struct SerialCommand {
+    enum class Kind : uint8_t { Open, Close, Write };
+
+    Kind kind = Kind::Write;
+    // Writes with the same non zero key supersede each other, see SerialService::send().
+    uint32_t key = 0;
+    uint32_t size = 0;
+    // Sequence number of a protocol frame, its ack is matched against it.
+    int16_t seq = -1;
+    // When set, the time from origin until the write finished is measured.
+    std::chrono::steady_clock::time_point origin;
+    std::array<char, SERIAL_COMMAND_SIZE> data;
+};
+
+struct SerialServiceStatus {
+    // Empty while no port is open.
+    std::string portName;
+    // Port of the last connect(), empty after disconnect(). Stays set while
+    // the port is gone, e.g. unplugged, to connect again once it is back.
+    std::string wantedPort;
+    // The device of the last connect(), only its path is known when it was
+    // connected to by path.
+    PortInfo wantedDevice;
+    std::string lastError;
+    uint64_t sent = 0;
+    uint64_t coalesced = 0;
+    uint64_t rejected = 0;
+    uint64_t failed = 0;
+    // From the origin of timed writes until they were written, milliseconds.
+    double recentLatencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+
+    // Frames acknowledged by the device, the ones it refused included, and
+    // acks which matched no frame in flight.
+    uint64_t acked = 0;
+    uint64_t strayAcks = 0;
+    uint64_t refused = 0;
+    // Frames whose sequence number came round again before any ack.
+    uint64_t unacked = 0;
+    // From starting to write a frame until its ack was read.
+    metrics::Percentiles roundTrip;
+    uint64_t bytesWritten = 0;
+    // Share of the baud rate used by writes over the last second or so,
+    // close to 1 means commands queue up in the UART.
+    double linkUtilization = 0.0;
+};
+
+// Owns the serial port and its I/O thread. The port stays open between
+// commands, callers only enqueue and never wait for the device, so it is
+// safe to use from the render loop or a control loop.
+class SerialService
+{
+public:
+    explicit SerialService(size_t queueCapacity = 64u, uint32_t baudrate = 9600u);
+    SerialService(const SerialService &) = delete;
+    SerialService &operator=(const SerialService &) = delete;
+    ~SerialService();
+
+    // Closes the current port, if any, and opens portName.
+    bool connect(const std::string &portName);
+    // Same for a discovered port, whose identity is kept to find it again.
+    bool connect(const PortInfo &port);
+    bool disconnect();
+    // Queues size bytes of data, nothing past them is written. Returns false
+    // when the queue is full. When the I/O thread falls behind, only the
+    // newest of the pending writes sharing a non zero key is sent, e.g. a
+    // servo position superseded by a newer one before it left the host.
+    // origin is e.g. the capture time of the frame the command reacts to.
+    bool send(const char *data, size_t size, uint32_t key = 0u,
+            std::chrono::steady_clock::time_point origin = {});
+    bool send(const std::string &data, uint32_t key = 0u);
+    // Encodes the frame, coalesces it by proto::coalescingKey() and waits for its ack.
+    bool sendFrame(const proto::Frame &frame, std::chrono::steady_clock::time_point origin = {});
+
+    // Sends what is already queued, closes the port and joins the I/O thread.
+    void stop();
+    // Cheaper than status() for loops which only need to know if sending makes sense.
+    bool isConnected() const { return connected_.load(std::memory_order_acquire); }
+    SerialServiceStatus status() const;
+    const metrics::Histogram &roundTrip() const { return roundTrip_; }
+
+private:
+    bool enqueue(SerialCommand::Kind kind, const char *data, size_t size, uint32_t key,
+            std::chrono::steady_clock::time_point origin = {}, int16_t seq = -1);
+    void loop();
+    void execute(const std::vector<SerialCommand> &batch);
+    void openPort(const std::string &portName);
+    void closePort();
+    void recordLatency(std::chrono::steady_clock::duration latency);
+    // Reader thread.
+    void onFrame(const proto::FrameView &frame, std::chrono::steady_clock::time_point received);
+    void fail(const std::string &error);
+
+    MpscQueue<SerialCommand> queue_;
+    const uint32_t baudrate_;
+    // Bumped after every push and on stop, the I/O thread sleeps on it.
+    std::atomic_uint32_t epoch_ = 0;
+    std::atomic_bool stopping_ = false;
+
+    // I/O thread only.
+    std::unique_ptr<SerialPort> port_;
+    std::unique_ptr<SerialReader> reader_;
+    std::atomic_bool connected_ = false;
+    // Ticks of the time each sequence number was last written, 0 once acked.
+    std::array<std::atomic_int64_t, 256> sentAt_{};
+
+    mutable std::mutex statusMutex_;
+    std::string portName_;
+    PortInfo wantedDevice_;
+    std::string lastError_;
+    std::atomic_uint64_t sent_ = 0;
+    std::atomic_uint64_t coalesced_ = 0;
+    std::atomic_uint64_t rejected_ = 0;
+    std::atomic_uint64_t failed_ = 0;
+    std::atomic<double> recentLatencyMs_ = 0.0;
+    std::atomic<double> maxLatencyMs_ = 0.0;
+    std::atomic_uint64_t acked_ = 0;
+    std::atomic_uint64_t strayAcks_ = 0;
+    std::atomic_uint64_t refused_ = 0;
+    std::atomic_uint64_t unacked_ = 0;
+    std::atomic_uint64_t bytesWritten_ = 0;
+    metrics::Histogram roundTrip_;
+    // Last sample for the link utilization, guarded by statusMutex_.
+    mutable std::chrono::steady_clock::time_point rateSampledAt_;
+    mutable uint64_t rateSampledBytes_ = 0;
+    mutable double linkUtilization_ = 0.0;
+
+    std::thread thread_;
+};
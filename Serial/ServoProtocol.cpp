@@ -0,0 +1,114 @@
+#include "ServoProtocol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace proto {
+    uint8_t crc8(const uint8_t *data, size_t size, uint8_t crc)
+    {
+        for (size_t i = 0; i < size; i++) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++)
+                crc = static_cast<uint8_t>(crc & 0x80u ? (crc << 1) ^ 0x07u : crc << 1);
+        }
+
+        return crc;
+    }
+
+    size_t encode(const Frame &frame, uint8_t *out)
+    {
+        const size_t size = std::min<size_t>(frame.size, MAX_PAYLOAD);
+        out[0] = SYNC;
+        out[1] = frame.seq;
+        out[2] = static_cast<uint8_t>(frame.opcode);
+        out[3] = static_cast<uint8_t>(size);
+        std::copy_n(frame.payload.begin(), size, out + HEADER_SIZE);
+        out[HEADER_SIZE + size] = crc8(out + 1, HEADER_SIZE - 1 + size);
+
+        return HEADER_SIZE + size + 1;
+    }
+
+    uint8_t nextSeq()
+    {
+        static std::atomic<uint8_t> seq = 0;
+
+        return seq.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Frame ping(uint8_t seq)
+    {
+        Frame frame;
+        frame.seq = seq;
+        frame.opcode = Opcode::Ping;
+
+        return frame;
+    }
+
+    Frame setAngle(uint8_t seq, uint8_t servo, float degrees)
+    {
+        const auto tenths = static_cast<uint16_t>(std::lround(std::clamp(degrees, 0.0f, 180.0f) * 10.0f));
+
+        Frame frame;
+        frame.seq = seq;
+        frame.opcode = Opcode::SetAngle;
+        frame.size = 3;
+        frame.payload[0] = servo;
+        frame.payload[1] = static_cast<uint8_t>(tenths & 0xFFu);
+        frame.payload[2] = static_cast<uint8_t>(tenths >> 8);
+
+        return frame;
+    }
+
+    uint32_t coalescingKey(const Frame &frame)
+    {
+        if (frame.opcode != Opcode::SetAngle || frame.size < 1) return 0u;
+
+        return static_cast<uint32_t>(frame.opcode) << 8 | frame.payload[0];
+    }
+
+    FrameCheck checkFrame(const uint8_t *ring, size_t mask, size_t start, size_t available)
+    {
+        if (available < HEADER_SIZE) return FrameCheck::Incomplete;
+        if (ring[start & mask] != SYNC) return FrameCheck::Invalid;
+
+        const size_t size = ring[(start + 3) & mask];
+        if (size > MAX_PAYLOAD) return FrameCheck::Invalid;
+        if (available < HEADER_SIZE + size + 1) return FrameCheck::Incomplete;
+
+        uint8_t crc = 0u;
+        for (size_t i = 1; i < HEADER_SIZE + size; i++) crc = crc8(&ring[(start + i) & mask], 1, crc);
+
+        return crc == ring[(start + HEADER_SIZE + size) & mask] ? FrameCheck::Valid : FrameCheck::Invalid;
+    }
+
+    Decoder::Step Decoder::step(uint8_t byte)
+    {
+        if (rawSize_ == 0) {
+            if (byte == SYNC) raw_[rawSize_++] = byte;
+            return Step::Partial;
+        }
+
+        raw_[rawSize_++] = byte;
+        if (rawSize_ == HEADER_SIZE && raw_[3] > MAX_PAYLOAD) {
+            lengthErrors_++;
+            return Step::Rejected;
+        }
+        if (rawSize_ < HEADER_SIZE || rawSize_ < HEADER_SIZE + raw_[3] + 1) return Step::Partial;
+
+        const size_t size = raw_[3];
+        if (crc8(raw_.data() + 1, HEADER_SIZE - 1 + size) != raw_[HEADER_SIZE + size]) {
+            crcErrors_++;
+            return Step::Rejected;
+        }
+
+        frame_.seq = raw_[1];
+        frame_.opcode = static_cast<Opcode>(raw_[2]);
+        frame_.size = static_cast<uint8_t>(size);
+        std::copy_n(raw_.begin() + HEADER_SIZE, size, frame_.payload.begin());
+        rawSize_ = 0;
+        frames_++;
+
+        return Step::Complete;
+    }
+}
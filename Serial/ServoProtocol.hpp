@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Framed binary protocol spoken with Arduino/GuardianBot/GuardianBot.ino,
+// keep both sides in sync.
+//
+// | 0xA5 | seq | opcode | length | payload, length bytes | crc8 |
+//
+// The CRC8 (polynomial 0x07, initial value 0) covers everything between the
+// sync byte and the CRC itself. Multi byte payload fields are little endian.
+namespace proto {
+    const uint8_t SYNC = 0xA5;
+    const size_t HEADER_SIZE = 4u;
+    const size_t MAX_PAYLOAD = 32u;
+    const size_t MAX_FRAME_SIZE = HEADER_SIZE + MAX_PAYLOAD + 1u;
+    const uint32_t BAUDRATE = 115200u;
+
+    enum class Opcode : uint8_t {
+        // No payload, answered with an Ack.
+        Ping = 0x01,
+        // servo index u8, angle in tenths of a degree u16 (0..1800).
+        SetAngle = 0x02,
+        // Device to host, seq of the acknowledged frame; opcode u8, AckStatus u8.
+        Ack = 0x80
+    };
+
+    enum class AckStatus : uint8_t {
+        Ok = 0,
+        UnknownOpcode = 1,
+        BadPayload = 2
+    };
+
+    struct Frame {
+        uint8_t seq = 0;
+        Opcode opcode = Opcode::Ping;
+        uint8_t size = 0;
+        std::array<uint8_t, MAX_PAYLOAD> payload{};
+    };
+
+    uint8_t crc8(const uint8_t *data, size_t size, uint8_t crc = 0u);
+
+    // Writes the frame into out, which must hold MAX_FRAME_SIZE bytes.
+    // Returns the number of bytes written.
+    size_t encode(const Frame &frame, uint8_t *out);
+
+    // Process wide sequence numbers, so frames sent from different threads
+    // can be told apart in the acks.
+    uint8_t nextSeq();
+
+    Frame ping(uint8_t seq);
+    // Clamps the angle to 0..180 degrees.
+    Frame setAngle(uint8_t seq, uint8_t servo, float degrees);
+    // Frames with the same key supersede each other, see SerialService::send().
+    uint32_t coalescingKey(const Frame &frame);
+
+    // Frame sitting in a receive ring buffer, read in place without copying.
+    // The ring size must be a power of two, mask is the size minus one.
+    class FrameView {
+    public:
+        FrameView(const uint8_t *ring, size_t mask, size_t start) : ring_(ring), mask_(mask), start_(start) {}
+
+        uint8_t seq() const { return this->at(1); }
+        Opcode opcode() const { return static_cast<Opcode>(this->at(2)); }
+        uint8_t size() const { return this->at(3); }
+        uint8_t payload(size_t i) const { return this->at(HEADER_SIZE + i); }
+        size_t frameSize() const { return HEADER_SIZE + this->size() + 1u; }
+
+    private:
+        uint8_t at(size_t i) const { return ring_[(start_ + i) & mask_]; }
+
+        const uint8_t *ring_;
+        size_t mask_;
+        size_t start_;
+    };
+
+    enum class FrameCheck { Incomplete, Invalid, Valid };
+    // Checks the frame whose sync byte is at start, available bytes from
+    // there on have been received.
+    FrameCheck checkFrame(const uint8_t *ring, size_t mask, size_t start, size_t available);
+
+    // Byte at a time decoder which never blocks and never allocates. On a bad
+    // length or CRC it resumes the search right after the rejected sync byte,
+    // so a frame hidden behind a false sync byte is not lost.
+    class Decoder {
+    public:
+        // Calls onFrame(const Frame &) for every frame the byte completed,
+        // usually none or one.
+        template <typename OnFrame>
+        void push(uint8_t byte, OnFrame &&onFrame) {
+            // Bytes still to be fed, the raw frame bytes plus the input never
+            // exceed one frame, see step().
+            std::array<uint8_t, MAX_FRAME_SIZE> input;
+            size_t count = 0, pos = 0;
+            input[count++] = byte;
+            while (pos < count) {
+                switch (this->step(input[pos++])) {
+                    case Step::Partial:
+                        break;
+                    case Step::Complete:
+                        onFrame(static_cast<const Frame &>(frame_));
+                        break;
+                    case Step::Rejected: {
+                        // Everything after the rejected sync byte goes in again.
+                        std::array<uint8_t, MAX_FRAME_SIZE> rest;
+                        size_t restCount = 0;
+                        for (size_t i = 1; i < rawSize_; i++) rest[restCount++] = raw_[i];
+                        while (pos < count) rest[restCount++] = input[pos++];
+                        rawSize_ = 0;
+                        input = rest;
+                        count = restCount;
+                        pos = 0;
+                        break;
+                    }
+                }
+            }
+        }
+
+        uint64_t frames() const { return frames_; }
+        uint64_t crcErrors() const { return crcErrors_; }
+        uint64_t lengthErrors() const { return lengthErrors_; }
+
+    private:
+        enum class Step { Partial, Complete, Rejected };
+        // Leaves the raw bytes of a rejected frame in place for the rescan.
+        Step step(uint8_t byte);
+
+        Frame frame_;
+        // Raw bytes of the frame being received, sync byte included.
+        std::array<uint8_t, MAX_FRAME_SIZE> raw_{};
+        size_t rawSize_ = 0;
+        uint64_t frames_ = 0;
+        uint64_t crcErrors_ = 0;
+        uint64_t lengthErrors_ = 0;
+    };
+}
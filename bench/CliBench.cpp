@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "cli/ArgumentParser.hpp"
+
+// The arguments of a typical deployment, registered the way main does.
+static void BM_ArgumentParserParse(benchmark::State &state) {
+    std::vector<std::string> args = { "GuardianBotApp", "--prototxt", "deploy.prototxt",
+        "--model", "res10_300x300_ssd_iter_140000.caffemodel", "--source", "0,1",
+        "--detect-every", "3", "--roi", "--follow" };
+    std::vector<char *> argv;
+    for (std::string &arg : args) argv.push_back(arg.data());
+
+    for (auto _ : state) {
+        cli::ArgumentParser ap;
+        ap.arg(cli::ArgType::String, { .fullName = "prototxt", .shortName = "p" });
+        ap.arg(cli::ArgType::String, { .fullName = "model", .shortName = "m" });
+        ap.arg(cli::ArgType::String, { .fullName = "source", .shortName = "s" });
+        ap.arg(cli::ArgType::Number, { .fullName = "detect-every", .shortName = "n" });
+        ap.arg(cli::ArgType::Flag, { .fullName = "roi", .shortName = "o" });
+        ap.arg(cli::ArgType::Flag, { .fullName = "follow", .shortName = "f" });
+        cli::ArgMap am = ap.parse(static_cast<int>(argv.size()), argv.data());
+        benchmark::DoNotOptimize(am);
+    }
+}
+BENCHMARK(BM_ArgumentParserParse);
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+
+#include "detect/BlobPreprocessor.hpp"
+#include "detect/SsdDecoder.hpp"
+
+namespace {
+    const cv::Size INPUT_SIZE(300, 300);
+    const cv::Scalar MEAN(104.0, 177.0, 123.0);
+
+    std::vector<cv::Mat> makeFrames(const benchmark::State &state) {
+        std::vector<cv::Mat> frames(static_cast<size_t>(state.range(2)));
+        for (cv::Mat &frame : frames) {
+            frame.create(static_cast<int>(state.range(1)), static_cast<int>(state.range(0)), CV_8UC3);
+            cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        }
+
+        return frames;
+    }
+
+    // Camera resolutions in use and batches of one and two streams.
+    void cameraSizes(benchmark::internal::Benchmark *b) {
+        b->ArgNames({ "width", "height", "batch" });
+        for (const auto &[width, height] : { std::pair(640, 480), std::pair(1280, 720), std::pair(1920, 1080) })
+            for (int batch : { 1, 2 })
+                b->Args({ width, height, batch });
+    }
+}
+
+static void BM_BlobFromImages(benchmark::State &state) {
+    const std::vector<cv::Mat> frames = makeFrames(state);
+    cv::Mat blob;
+    for (auto _ : state) {
+        cv::dnn::blobFromImages(frames, blob, 1.0, INPUT_SIZE, MEAN, false, false);
+        benchmark::DoNotOptimize(blob.data);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(2));
+}
+BENCHMARK(BM_BlobFromImages)->Apply(cameraSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_BlobPreprocessor(benchmark::State &state) {
+    const std::vector<cv::Mat> frames = makeFrames(state);
+    detect::BlobPreprocessor preprocessor(INPUT_SIZE, MEAN);
+    state.SetLabel(preprocessor.path());
+    cv::Mat blob;
+    for (auto _ : state) {
+        preprocessor.run(frames, blob);
+        benchmark::DoNotOptimize(blob.data);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(2));
+}
+BENCHMARK(BM_BlobPreprocessor)->Apply(cameraSizes)->Unit(benchmark::kMicrosecond);
+
+// The DetectionOutput layer of the model keeps up to 200 boxes per batch.
+static void BM_DecodeSsdOutput(benchmark::State &state) {
+    const int rows = static_cast<int>(state.range(0));
+    const int sizes[] = { 1, 1, rows, 7 };
+    cv::Mat output(4, sizes, CV_32F);
+    cv::RNG rng(42);
+    float *data = output.ptr<float>();
+    for (int i = 0; i < rows; i++) {
+        float *row = data + static_cast<size_t>(i) * 7;
+        const float left = rng.uniform(0.0f, 0.8f), top = rng.uniform(0.0f, 0.8f);
+        row[0] = static_cast<float>(i % 2);
+        row[1] = 1.0f;
+        row[2] = rng.uniform(0.0f, 1.0f);
+        row[3] = left;
+        row[4] = top;
+        row[5] = left + rng.uniform(0.05f, 0.2f);
+        row[6] = top + rng.uniform(0.05f, 0.2f);
+    }
+    const std::vector<cv::Size> frameSizes = { cv::Size(1280, 720), cv::Size(1280, 720) };
+
+    for (auto _ : state) {
+        std::vector<detect::Detections> decoded = detect::decodeSsdOutput(output, frameSizes, 0.8f);
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_DecodeSsdOutput)->Arg(10)->Arg(200)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include <opencv2/core.hpp>
+
+#include "vidIO/FrameRing.hpp"
+
+namespace {
+    void cameraSizes(benchmark::internal::Benchmark *b) {
+        b->ArgNames({ "width", "height" });
+        b->Args({ 640, 480 })->Args({ 1280, 720 })->Args({ 1920, 1080 });
+    }
+
+    cv::Mat makeFrame(const benchmark::State &state) {
+        cv::Mat frame(static_cast<int>(state.range(1)), static_cast<int>(state.range(0)), CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+        return frame;
+    }
+}
+
+// What capture costs per frame on top of decoding: one copy into a ring slot.
+static void BM_FrameRingPush(benchmark::State &state) {
+    const cv::Mat frame = makeFrame(state);
+    vidIO::FrameRing ring({ static_cast<uint64_t>(frame.cols), static_cast<uint64_t>(frame.rows) });
+    for (auto _ : state) benchmark::DoNotOptimize(ring.push(frame));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.total() * frame.elemSize()));
+}
+BENCHMARK(BM_FrameRingPush)->Apply(cameraSizes)->Unit(benchmark::kMicrosecond);
+
+// The copy and vertical flip the texture upload used to do on the CPU before
+// the shader took over, kept as the baseline it is compared against.
+static void BM_FrameCopyFlip(benchmark::State &state) {
+    const cv::Mat frame = makeFrame(state);
+    cv::Mat flipped;
+    for (auto _ : state) {
+        cv::flip(frame, flipped, 0);
+        benchmark::DoNotOptimize(flipped.data);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.total() * frame.elemSize()));
+}
+BENCHMARK(BM_FrameCopyFlip)->Apply(cameraSizes)->Unit(benchmark::kMicrosecond);
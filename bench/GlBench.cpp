@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <opencv2/core.hpp>
+
+#include "gl/StreamingTexture.hpp"
+
+namespace {
+    // Hidden window, its context is all that is needed for uploads.
+    struct OffscreenContext {
+        OffscreenContext() {
+            if (!glfwInit()) return;
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_CORE_PROFILE, GLFW_TRUE);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            wnd = glfwCreateWindow(64, 64, "GuardianBotBench", nullptr, nullptr);
+            if (!wnd) return;
+            glfwMakeContextCurrent(wnd);
+            glewExperimental = GL_TRUE;
+            ready = glewInit() == GLEW_OK;
+        }
+        ~OffscreenContext() {
+            if (wnd) glfwDestroyWindow(wnd);
+            glfwTerminate();
+        }
+
+        GLFWwindow *wnd = nullptr;
+        bool ready = false;
+    };
+}
+
+// Frames handed to the streaming texture as the display stage does. The
+// upload only queues the transfer, glFinish() makes it part of the timing.
+static void BM_StreamingTextureUpload(benchmark::State &state) {
+    const OffscreenContext context;
+    if (!context.ready) {
+        state.SkipWithError("No OpenGL 4.3 context available.");
+        return;
+    }
+
+    cv::Mat frame(static_cast<int>(state.range(1)), static_cast<int>(state.range(0)), CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    {
+        gl::StreamingTexture texture(frame.cols, frame.rows);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(texture.upload(frame));
+            glFinish();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.total() * frame.elemSize()));
+}
+BENCHMARK(BM_StreamingTextureUpload)->ArgNames({ "width", "height" })
+    ->Args({ 640, 480 })->Args({ 1280, 720 })->Args({ 1920, 1080 })->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <vector>
+
+#include "Serial/ServoProtocol.hpp"
+
+// Building and encoding one servo command, what the control stage does per tick.
+static void BM_EncodeSetAngle(benchmark::State &state) {
+    std::array<uint8_t, proto::MAX_FRAME_SIZE> out;
+    uint8_t seq = 0;
+    float angle = 0.0f;
+    for (auto _ : state) {
+        const proto::Frame frame = proto::setAngle(seq++, 0, angle);
+        angle = angle < 180.0f ? angle + 0.1f : 0.0f;
+        benchmark::DoNotOptimize(proto::encode(frame, out.data()));
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_EncodeSetAngle);
+
+// Decoding a stream of acks byte by byte as the sketch and the host do.
+static void BM_DecodeAcks(benchmark::State &state) {
+    std::vector<uint8_t> stream;
+    std::array<uint8_t, proto::MAX_FRAME_SIZE> out;
+    for (int i = 0; i < 256; i++) {
+        proto::Frame ack;
+        ack.opcode = proto::Opcode::Ack;
+        ack.seq = static_cast<uint8_t>(i);
+        ack.size = 2;
+        ack.payload[0] = static_cast<uint8_t>(proto::Opcode::SetAngle);
+        ack.payload[1] = static_cast<uint8_t>(proto::AckStatus::Ok);
+        const size_t size = proto::encode(ack, out.data());
+        stream.insert(stream.end(), out.cbegin(), out.cbegin() + static_cast<ptrdiff_t>(size));
+    }
+
+    proto::Decoder decoder;
+    size_t frames = 0;
+    for (auto _ : state) {
+        for (uint8_t byte : stream) decoder.push(byte, [&](const proto::Frame &) { frames++; });
+    }
+    benchmark::DoNotOptimize(frames);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(stream.size()));
+}
+BENCHMARK(BM_DecodeAcks);
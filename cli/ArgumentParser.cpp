@@ -1,5 +1,7 @@
 #include "ArgumentParser.hpp"
 
+#include <algorithm>
+
 namespace cli {
     auto ArgumentParser::arg(ArgType &&type, ArgName &&name) -> void {
         this->registerArg({ .type = std::move(type), .name = std::move(name) });
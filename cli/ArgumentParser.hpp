@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <cstdlib>
 #include <map>
 #include <string>
 #include <string_view>
@@ -13,7 +14,7 @@
 template <typename T>
 concept Numeric = std::integral<T> || std::floating_point<T>;
 template <typename T>
-concept Extractable = Numeric || std::same_as<T, std::string>;
+concept Extractable = Numeric<T> || std::same_as<T, std::string>;
 
 namespace cli {
     enum class ArgType {
@@ -34,27 +35,25 @@ namespace cli {
 
         template <Extractable ExtractedType>
         auto get() -> ExtractedType {
-            switch(this->type_) {
-                case ArgType::Number:
-                    if constexpr (std::is_floating_point<ExtractedType>())
-                        return std::atof(raw_);
-                    if constexpr (std::is_integral<ExtractedType>())
-                        return std::atoi(raw_);
-                    break;
-                case ArgType::List:
-                    // TODO: just create some implementation already
-                    return raw_;
-                    break;
-                case ArgType::String:
-                    if constexpr (std::is_same<ExtractedType, std::string>())
-                        return raw_;
-                    break;
-                case ArgType::Flag:
-                    if constexpr (std::is_integral<ExtractedType>())
-                        return true;
+            if constexpr (std::is_same<ExtractedType, std::string>()) {
+                // TODO: just create some implementation for lists already
+                return raw_;
+            }
+            else {
+                switch(this->type_) {
+                    case ArgType::Number: {
+                        char *end = nullptr;
+                        const double value = std::strtod(raw_.c_str(), &end);
+                        if (raw_.empty() || *end != '\0')
+                            throw BasicException("Argument value '" + raw_ + "' is not a number.");
+                        return static_cast<ExtractedType>(value);
+                    }
+                    case ArgType::Flag:
+                        return static_cast<ExtractedType>(true);
+                    default:
+                        throw BasicException("Argument value '" + raw_ + "' is not a number.");
+                }
             }
-
-            return raw_;
         }
     private:
         ArgType type_;
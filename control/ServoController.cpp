@@ -0,0 +1,81 @@
+#include "ServoController.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace control {
+    ServoController::ServoController(const Params &params, float angle)
+        : params_(params), angle_(std::clamp(angle, params.minAngle, params.maxAngle)) {}
+
+    float ServoController::update(const ServoTarget &target, Clock::time_point now) {
+        const float dt = lastUpdate_ == Clock::time_point()
+                ? 0.0f : std::chrono::duration<float>(now - lastUpdate_).count();
+        lastUpdate_ = now;
+
+        const bool fresh = target.valid &&
+                std::chrono::duration<float, std::milli>(now - target.captured).count() <= params_.lostAfterMs;
+        if (!fresh || dt <= 0.0f) {
+            // Nobody to follow, hold the position and forget the accumulated error.
+            error_ = 0.0f;
+            integral_ = 0.0f;
+            previousError_ = 0.0f;
+            this->remember(now);
+            return angle_;
+        }
+
+        const float measured = (params_.inverted ? -0.5f : 0.5f) * params_.fovDeg * target.offset;
+        // The face has moved across the image by however far the servo turned
+        // since the frame was captured.
+        error_ = measured - (angle_ - this->angleAt(target.captured));
+        if (std::abs(error_) < params_.deadbandDeg) {
+            // Close enough, hold still instead of hunting around the face.
+            previousError_ = 0.0f;
+            this->remember(now);
+            return angle_;
+        }
+        const float error = error_;
+
+        const float integral = std::clamp(integral_ + error * dt, -params_.integralLimitDegS, params_.integralLimitDegS);
+        const float derivative = (error - previousError_) / dt;
+        previousError_ = error;
+
+        const float rate = std::clamp(params_.kp * error + params_.ki * integral + params_.kd * derivative,
+                -params_.maxRateDegPerS, params_.maxRateDegPerS);
+        const float unclamped = angle_ + rate * dt;
+        angle_ = std::clamp(unclamped, params_.minAngle, params_.maxAngle);
+        // The integral only grows while the servo can still follow it.
+        if (angle_ == unclamped) integral_ = integral;
+
+        this->remember(now);
+
+        return angle_;
+    }
+
+    void ServoController::reset(float angle, Clock::time_point now) {
+        angle_ = std::clamp(angle, params_.minAngle, params_.maxAngle);
+        error_ = 0.0f;
+        integral_ = 0.0f;
+        previousError_ = 0.0f;
+        lastUpdate_ = now;
+        historySize_ = 0;
+        this->remember(now);
+    }
+
+    float ServoController::angleAt(Clock::time_point time) const {
+        if (historySize_ == 0) return angle_;
+
+        // Newest first, the sample in effect at the given time.
+        for (size_t i = 1; i <= historySize_; i++) {
+            const Sample &sample = history_[(historyNext_ + history_.size() - i) % history_.size()];
+            if (sample.time <= time) return sample.angle;
+        }
+
+        return history_[(historyNext_ + history_.size() - historySize_) % history_.size()].angle;
+    }
+
+    void ServoController::remember(Clock::time_point time) {
+        history_[historyNext_] = { time, angle_ };
+        historyNext_ = (historyNext_ + 1) % history_.size();
+        historySize_ = std::min(historySize_ + 1, history_.size());
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace control {
+    using Clock = std::chrono::steady_clock;
+
+    // Where the followed face was in the frame, published once per processed frame.
+    struct ServoTarget {
+        bool valid = false;
+        // Horizontal offset of the face centre from the frame centre, -1 at the
+        // left border and 1 at the right one.
+        float offset = 0.0f;
+        Clock::time_point captured;
+        uint64_t sequence = 0;
+        int trackId = -1;
+    };
+
+    // Pan controller for a camera carried by the servo. A PID on the angular
+    // error drives the servo speed, which is rate limited and integrated into
+    // the commanded angle on a fixed control period.
+    //
+    // Measurements are older than the command, the servo kept turning since
+    // the frame was captured. The error is corrected by that movement, taken
+    // from the history of commanded angles, so a slow detector doesn't make
+    // the controller overshoot.
+    class ServoController {
+    public:
+        struct Params {
+            // Servo speed in degrees per second per degree of error.
+            float kp = 10.0f;
+            float ki = 1.0f;
+            float kd = 0.05f;
+            // Horizontal field of view of the camera, converts offsets to degrees.
+            float fovDeg = 60.0f;
+            // Errors below this are treated as none so the servo doesn't jitter.
+            float deadbandDeg = 1.5f;
+            float maxRateDegPerS = 120.0f;
+            float minAngle = 0.0f;
+            float maxAngle = 180.0f;
+            // Measurements older than this are ignored and the servo holds still.
+            float lostAfterMs = 500.0f;
+            // Limits the integral so it can't wind up while the servo is saturated.
+            float integralLimitDegS = 40.0f;
+            // Set when turning the servo to greater angles moves the image left.
+            bool inverted = false;
+        };
+
+        explicit ServoController(float angle = 90.0f) : ServoController(Params(), angle) {}
+        ServoController(const Params &params, float angle);
+
+        // Advances the controller to now and returns the commanded angle.
+        float update(const ServoTarget &target, Clock::time_point now);
+        // Continues from the given angle, e.g. after it was set by hand.
+        void reset(float angle, Clock::time_point now);
+
+        float angle() const { return angle_; }
+        // Error of the last valid measurement corrected by the movement since, degrees.
+        float error() const { return error_; }
+
+    private:
+        float angleAt(Clock::time_point time) const;
+        void remember(Clock::time_point time);
+
+        const Params params_;
+        float angle_;
+        float error_ = 0.0f;
+        float integral_ = 0.0f;
+        float previousError_ = 0.0f;
+        Clock::time_point lastUpdate_;
+
+        // Commanded angles of the last updates, enough to cover lostAfterMs at
+        // common control rates.
+        struct Sample {
+            Clock::time_point time;
+            float angle;
+        };
+        std::array<Sample, 64> history_{};
+        size_t historyNext_ = 0;
+        size_t historySize_ = 0;
+    };
+}
@@ -0,0 +1,188 @@
+#include "BackendTuner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ModelHash.hpp"
+
+namespace detect {
+    namespace {
+        std::string backendName(int backend) {
+            switch (backend) {
+                case cv::dnn::DNN_BACKEND_DEFAULT: return "default";
+                case cv::dnn::DNN_BACKEND_OPENCV: return "opencv";
+                case cv::dnn::DNN_BACKEND_INFERENCE_ENGINE: return "inference-engine";
+                default: return std::to_string(backend);
+            }
+        }
+
+        std::string targetName(int target) {
+            switch (target) {
+                case cv::dnn::DNN_TARGET_CPU: return "cpu";
+                case cv::dnn::DNN_TARGET_OPENCL: return "opencl";
+                case cv::dnn::DNN_TARGET_OPENCL_FP16: return "opencl-fp16";
+                default: return std::to_string(target);
+            }
+        }
+
+        std::vector<BackendChoice> candidates() {
+            const cv::dnn::Backend backends[] = {
+                cv::dnn::DNN_BACKEND_OPENCV,
+                cv::dnn::DNN_BACKEND_INFERENCE_ENGINE
+            };
+            const cv::dnn::Target wanted[] = {
+                cv::dnn::DNN_TARGET_CPU,
+                cv::dnn::DNN_TARGET_OPENCL,
+                cv::dnn::DNN_TARGET_OPENCL_FP16
+            };
+
+            std::vector<BackendChoice> choices;
+            for (cv::dnn::Backend backend : backends)
+                for (cv::dnn::Target target : cv::dnn::getAvailableTargets(backend))
+                    if (std::find(std::begin(wanted), std::end(wanted), target) != std::end(wanted))
+                        choices.push_back({ backend, target });
+
+            return choices;
+        }
+
+        std::string cpuName() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            int regs[12] = {};
+            __cpuid(regs, 0x80000000);
+            if (static_cast<unsigned>(regs[0]) >= 0x80000004u) {
+                for (int leaf = 0; leaf < 3; leaf++) __cpuid(regs + 4 * leaf, 0x80000002 + leaf);
+                return std::string(reinterpret_cast<const char *>(regs), sizeof(regs)).c_str();
+            }
+#elif defined(__x86_64__) || defined(__i386__)
+            // Brand string from CPUID leaves 0x80000002..0x80000004.
+            unsigned int regs[12] = {};
+            if (__get_cpuid_max(0x80000000u, nullptr) >= 0x80000004u) {
+                for (unsigned int leaf = 0; leaf < 3; leaf++)
+                    __get_cpuid(0x80000002u + leaf, &regs[4 * leaf], &regs[4 * leaf + 1], &regs[4 * leaf + 2],
+                            &regs[4 * leaf + 3]);
+                return std::string(reinterpret_cast<const char *>(regs), sizeof(regs)).c_str();
+            }
+#endif
+            // Elsewhere, e.g. ARM, the kernel names the CPU or the board.
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line))
+                if (line.rfind("model name", 0) == 0 || line.rfind("Hardware", 0) == 0 || line.rfind("Model", 0) == 0)
+                    return line.substr(line.find(':') + 1);
+
+            return "";
+        }
+
+        std::string hostName() {
+#ifdef _WIN32
+            const char *name = std::getenv("COMPUTERNAME");
+            return name ? name : "";
+#else
+            char name[256] = {};
+            return gethostname(name, sizeof(name) - 1) == 0 ? name : "";
+#endif
+        }
+
+        uint64_t hostHash() {
+            const std::string host = hostName() + '\n' + cpuName() + '\n'
+                    + std::to_string(std::thread::hardware_concurrency());
+
+            return fnv1a(host.data(), host.size());
+        }
+    }
+
+    std::string describe(const BackendChoice &choice) {
+        return backendName(choice.backend) + "/" + targetName(choice.target);
+    }
+
+    BackendTuner::BackendTuner(std::string cachePath, int warmupRuns, int timedRuns)
+        : cachePath_(std::move(cachePath)), hostHash_(hostHash()), warmupRuns_(warmupRuns),
+          timedRuns_(std::max(timedRuns, 1)) {}
+
+    std::string BackendTuner::key(uint64_t modelHash, int batchSize) const {
+        // One token, lines of older versions simply never match.
+        return hashToString(modelHash) + ":" + std::to_string(batchSize) + ":" + hashToString(hostHash_);
+    }
+
+    std::optional<BackendChoice> BackendTuner::cached(uint64_t modelHash, int batchSize) const {
+        std::ifstream file(cachePath_);
+        const std::string key = this->key(modelHash, batchSize);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string hash;
+            BackendChoice choice;
+            if (fields >> hash >> choice.backend >> choice.target && hash == key) return choice;
+        }
+
+        return std::nullopt;
+    }
+
+    void BackendTuner::store(uint64_t modelHash, int batchSize, const BackendChoice &choice) const {
+        const std::string key = this->key(modelHash, batchSize) + " ";
+        std::vector<std::string> lines;
+        {
+            std::ifstream file(cachePath_);
+            std::string line;
+            while (std::getline(file, line))
+                if (line.compare(0, key.size(), key) != 0) lines.push_back(line);
+        }
+        lines.push_back(key + std::to_string(choice.backend) + " " + std::to_string(choice.target));
+
+        std::ofstream file(cachePath_, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Can't write backend cache '" + cachePath_ + "'.");
+        for (const std::string &line : lines) file << line << '\n';
+    }
+
+    std::vector<BackendTiming> BackendTuner::benchmark(cv::dnn::Net &net, const cv::Mat &input) const {
+        using clock = std::chrono::steady_clock;
+
+        std::vector<BackendTiming> timings;
+        cv::Mat output;
+        for (const BackendChoice &choice : candidates()) {
+            BackendTiming timing = { choice };
+            try {
+                apply(net, choice);
+                net.setInput(input);
+                // The first passes also compile kernels and allocate, keep them out.
+                for (int i = 0; i < warmupRuns_; i++) net.forward(output);
+
+                const clock::time_point start = clock::now();
+                for (int i = 0; i < timedRuns_; i++) net.forward(output);
+                const std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+                timing.averageMs = elapsed.count() / timedRuns_;
+            }
+            catch (const std::exception &e) {
+                timing.error = e.what();
+            }
+            timings.push_back(std::move(timing));
+        }
+
+        std::stable_sort(timings.begin(), timings.end(), [](const BackendTiming &a, const BackendTiming &b) {
+            if (a.error.empty() != b.error.empty()) return a.error.empty();
+            return a.averageMs < b.averageMs;
+        });
+
+        return timings;
+    }
+
+    void BackendTuner::apply(cv::dnn::Net &net, const BackendChoice &choice) {
+        net.setPreferableBackend(choice.backend);
+        net.setPreferableTarget(choice.target);
+    }
+}
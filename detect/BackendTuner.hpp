@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+
+namespace detect {
+    struct BackendChoice {
+        int backend = cv::dnn::DNN_BACKEND_DEFAULT;
+        int target = cv::dnn::DNN_TARGET_CPU;
+    };
+
+    struct BackendTiming {
+        BackendChoice choice;
+        double averageMs = 0.0;
+        // Empty if the combination worked on this host.
+        std::string error;
+    };
+
+    std::string describe(const BackendChoice &choice);
+
+    // Picks the fastest backend/target pair for a network by timing forward
+    // passes of the real model. The winner is remembered in a small text file
+    // per model hash, batch size and host, so later starts skip the measurement
+    // until one of them changes.
+    class BackendTuner {
+    public:
+        explicit BackendTuner(std::string cachePath, int warmupRuns = 3, int timedRuns = 10);
+
+        std::optional<BackendChoice> cached(uint64_t modelHash, int batchSize) const;
+        void store(uint64_t modelHash, int batchSize, const BackendChoice &choice) const;
+
+        // Times every available combination of the OpenCV and Inference Engine
+        // backends with CPU and OpenCL (FP32 and FP16) targets on the given
+        // input. Working combinations come first, fastest first. The network is
+        // left configured with whatever was measured last.
+        std::vector<BackendTiming> benchmark(cv::dnn::Net &net, const cv::Mat &input) const;
+
+        static void apply(cv::dnn::Net &net, const BackendChoice &choice);
+
+    private:
+        std::string key(uint64_t modelHash, int batchSize) const;
+
+        const std::string cachePath_;
+        // Host name, CPU model and core count, hashed.
+        const uint64_t hostHash_;
+        const int warmupRuns_;
+        const int timedRuns_;
+    };
+}
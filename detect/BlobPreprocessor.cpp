@@ -0,0 +1,231 @@
+#include "BlobPreprocessor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GB_X86_SIMD 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define GB_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define GB_TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define GB_ARM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace detect {
+    namespace {
+        const int CHANNELS = 3;
+
+        // Same source coordinate mapping as cv::resize with INTER_LINEAR:
+        // pixel centers are aligned and borders are replicated.
+        void fillTable(int dstSize, int srcSize, int stride, std::vector<int> &ofs0, std::vector<int> &ofs1,
+                std::vector<float> &alpha) {
+            const double scale = static_cast<double>(srcSize) / dstSize;
+            ofs0.resize(dstSize);
+            ofs1.resize(dstSize);
+            alpha.resize(dstSize);
+            for (int d = 0; d < dstSize; d++) {
+                const double s = (d + 0.5) * scale - 0.5;
+                int s0 = static_cast<int>(std::floor(s));
+                float a = static_cast<float>(s - s0);
+                if (s0 < 0) {
+                    s0 = 0;
+                    a = 0.0f;
+                }
+                if (s0 >= srcSize - 1) {
+                    s0 = srcSize - 1;
+                    a = 0.0f;
+                }
+                const int s1 = std::min(s0 + 1, srcSize - 1);
+                ofs0[d] = s0 * stride;
+                ofs1[d] = s1 * stride;
+                alpha[d] = a;
+            }
+        }
+
+#ifdef GB_X86_SIMD
+        GB_TARGET_AVX2
+        int resizeRowAvx2(const unsigned char *src, float *dst, int width, int safeCols,
+                const int *xofs0, const int *xofs1, const float *xalpha) {
+            const __m256i lowByte = _mm256_set1_epi32(0xFF);
+            int dx = 0;
+            for (; dx + 8 <= safeCols; dx += 8) {
+                const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xofs0 + dx));
+                const __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xofs1 + dx));
+                // Each gathered word holds B, G, R of the pixel and one extra byte.
+                const __m256i left = _mm256_i32gather_epi32(reinterpret_cast<const int *>(src), idx0, 1);
+                const __m256i right = _mm256_i32gather_epi32(reinterpret_cast<const int *>(src), idx1, 1);
+                const __m256 a = _mm256_loadu_ps(xalpha + dx);
+                for (int c = 0; c < CHANNELS; c++) {
+                    const __m256 l = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(left, 8 * c), lowByte));
+                    const __m256 r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(right, 8 * c), lowByte));
+                    _mm256_storeu_ps(dst + c * width + dx, _mm256_fmadd_ps(a, _mm256_sub_ps(r, l), l));
+                }
+            }
+
+            return dx;
+        }
+
+        GB_TARGET_AVX2
+        int blendRowsAvx2(const float *upper, const float *lower, float alpha, const float *mean,
+                int width, float *dst, size_t planeSize) {
+            const __m256 a = _mm256_set1_ps(alpha);
+            int dx = 0;
+            for (int c = 0; c < CHANNELS; c++) {
+                const float *u = upper + c * width;
+                const float *l = lower + c * width;
+                float *d = dst + c * planeSize;
+                const __m256 m = _mm256_set1_ps(mean[c]);
+                for (dx = 0; dx + 8 <= width; dx += 8) {
+                    const __m256 uv = _mm256_loadu_ps(u + dx);
+                    const __m256 lv = _mm256_loadu_ps(l + dx);
+                    _mm256_storeu_ps(d + dx, _mm256_sub_ps(_mm256_fmadd_ps(a, _mm256_sub_ps(lv, uv), uv), m));
+                }
+            }
+
+            return dx;
+        }
+#endif
+
+#ifdef GB_ARM_NEON
+        int blendRowsNeon(const float *upper, const float *lower, float alpha, const float *mean,
+                int width, float *dst, size_t planeSize) {
+            const float32x4_t a = vdupq_n_f32(alpha);
+            int dx = 0;
+            for (int c = 0; c < CHANNELS; c++) {
+                const float *u = upper + c * width;
+                const float *l = lower + c * width;
+                float *d = dst + c * planeSize;
+                const float32x4_t m = vdupq_n_f32(mean[c]);
+                for (dx = 0; dx + 4 <= width; dx += 4) {
+                    const float32x4_t uv = vld1q_f32(u + dx);
+                    const float32x4_t lv = vld1q_f32(l + dx);
+                    vst1q_f32(d + dx, vsubq_f32(vmlaq_f32(uv, vsubq_f32(lv, uv), a), m));
+                }
+            }
+
+            return dx;
+        }
+#endif
+    }
+
+    BlobPreprocessor::BlobPreprocessor(cv::Size inputSize, const cv::Scalar &mean, bool useSimd)
+        : inputSize_(inputSize),
+          mean_{ static_cast<float>(mean[0]), static_cast<float>(mean[1]), static_cast<float>(mean[2]) } {
+#if defined(GB_X86_SIMD)
+        useSimd_ = useSimd && cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3);
+#elif defined(GB_ARM_NEON)
+        useSimd_ = useSimd;
+#else
+        (void)useSimd;
+#endif
+        rowsCache_.resize(2u * CHANNELS * inputSize_.width);
+    }
+
+    const char *BlobPreprocessor::path() const {
+#if defined(GB_X86_SIMD)
+        return useSimd_ ? "avx2" : "scalar";
+#elif defined(GB_ARM_NEON)
+        return useSimd_ ? "neon" : "scalar";
+#else
+        return "scalar";
+#endif
+    }
+
+    void BlobPreprocessor::run(const std::vector<cv::Mat> &images, cv::Mat &blob) {
+        const int sizes[] = { static_cast<int>(images.size()), CHANNELS, inputSize_.height, inputSize_.width };
+        blob.create(4, sizes, CV_32F);
+
+        const size_t imageSize = static_cast<size_t>(CHANNELS) * inputSize_.area();
+        float *dst = blob.ptr<float>();
+        for (const cv::Mat &image : images) {
+            if (image.type() != CV_8UC3)
+                throw std::invalid_argument("Blob preprocessor expects 8-bit BGR images.");
+
+            this->processImage(image, dst);
+            dst += imageSize;
+        }
+    }
+
+    void BlobPreprocessor::prepareTables(int srcWidth, int srcHeight) {
+        if (srcWidth == tablesWidth_ && srcHeight == tablesHeight_) return;
+
+        fillTable(inputSize_.width, srcWidth, CHANNELS, xofs0_, xofs1_, xalpha_);
+        fillTable(inputSize_.height, srcHeight, 1, yofs0_, yofs1_, yalpha_);
+
+        const int rowBytes = srcWidth * CHANNELS;
+        gatherSafeCols_ = 0;
+        while (gatherSafeCols_ < inputSize_.width && xofs1_[gatherSafeCols_] + 4 <= rowBytes)
+            gatherSafeCols_++;
+
+        tablesWidth_ = srcWidth;
+        tablesHeight_ = srcHeight;
+    }
+
+    void BlobPreprocessor::processImage(const cv::Mat &image, float *dst) {
+        this->prepareTables(image.cols, image.rows);
+        cachedRows_[0] = cachedRows_[1] = -1;
+
+        for (int dy = 0; dy < inputSize_.height; dy++) {
+            const float *upper = this->resizedRow(image, yofs0_[dy]);
+            const float *lower = this->resizedRow(image, yofs1_[dy]);
+            this->blendRows(upper, lower, yalpha_[dy], dst + static_cast<size_t>(dy) * inputSize_.width);
+        }
+    }
+
+    const float *BlobPreprocessor::resizedRow(const cv::Mat &image, int srcRow) {
+        const size_t rowFloats = static_cast<size_t>(CHANNELS) * inputSize_.width;
+        for (int i = 0; i < 2; i++)
+            if (cachedRows_[i] == srcRow) {
+                evictNext_ = 1 - i;
+                return rowsCache_.data() + i * rowFloats;
+            }
+
+        const int slot = evictNext_;
+        float *row = rowsCache_.data() + slot * rowFloats;
+        this->resizeRow(image.ptr(srcRow), row);
+        cachedRows_[slot] = srcRow;
+        evictNext_ = 1 - slot;
+
+        return row;
+    }
+
+    void BlobPreprocessor::resizeRow(const unsigned char *src, float *dst) const {
+        const int width = inputSize_.width;
+        int dx = 0;
+#ifdef GB_X86_SIMD
+        if (useSimd_)
+            dx = resizeRowAvx2(src, dst, width, gatherSafeCols_, xofs0_.data(), xofs1_.data(), xalpha_.data());
+#endif
+        for (; dx < width; dx++) {
+            const unsigned char *l = src + xofs0_[dx];
+            const unsigned char *r = src + xofs1_[dx];
+            const float a = xalpha_[dx];
+            for (int c = 0; c < CHANNELS; c++)
+                dst[c * width + dx] = l[c] + a * (static_cast<float>(r[c]) - l[c]);
+        }
+    }
+
+    void BlobPreprocessor::blendRows(const float *upper, const float *lower, float alpha, float *dst) const {
+        const int width = inputSize_.width;
+        const size_t planeSize = static_cast<size_t>(inputSize_.area());
+        int dx = 0;
+#if defined(GB_X86_SIMD)
+        if (useSimd_) dx = blendRowsAvx2(upper, lower, alpha, mean_, width, dst, planeSize);
+#elif defined(GB_ARM_NEON)
+        if (useSimd_) dx = blendRowsNeon(upper, lower, alpha, mean_, width, dst, planeSize);
+#endif
+        for (int c = 0; c < CHANNELS; c++) {
+            const float *u = upper + c * width;
+            const float *l = lower + c * width;
+            float *d = dst + c * planeSize;
+            for (int x = dx; x < width; x++)
+                d[x] = u[x] + alpha * (l[x] - u[x]) - mean_[c];
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace detect {
+    // Builds the network input blob from 8-bit BGR frames in a single pass:
+    // bilinear resize, float conversion, mean subtraction and HWC to NCHW
+    // reordering are fused per output row, no intermediate images are made and
+    // the blob storage is reused between calls of the same batch size.
+    // Produces what cv::dnn::blobFromImages(images, blob, 1.0, inputSize, mean,
+    // false, false) does, up to the rounding of OpenCV's fixed point resize.
+    class BlobPreprocessor {
+    public:
+        // Without useSimd the scalar code runs even where the CPU has AVX2 or
+        // NEON, so tests and benchmarks can compare the paths.
+        BlobPreprocessor(cv::Size inputSize, const cv::Scalar &mean, bool useSimd = true);
+
+        void run(const std::vector<cv::Mat> &images, cv::Mat &blob);
+
+        // Name of the code path in use: "avx2", "neon" or "scalar".
+        const char *path() const;
+
+    private:
+        void prepareTables(int srcWidth, int srcHeight);
+        void processImage(const cv::Mat &image, float *dst);
+        const float *resizedRow(const cv::Mat &image, int srcRow);
+        void resizeRow(const unsigned char *src, float *dst) const;
+        void blendRows(const float *upper, const float *lower, float alpha, float *dst) const;
+
+        const cv::Size inputSize_;
+        float mean_[3];
+        bool useSimd_ = false;
+
+        int tablesWidth_ = -1;
+        int tablesHeight_ = -1;
+        // Byte offsets of the left and right source pixel and the right weight
+        // for every output column, the same for rows.
+        std::vector<int> xofs0_;
+        std::vector<int> xofs1_;
+        std::vector<float> xalpha_;
+        std::vector<int> yofs0_;
+        std::vector<int> yofs1_;
+        std::vector<float> yalpha_;
+        // Output columns below this one can read 4 bytes at xofs1_ without
+        // leaving the source row.
+        int gatherSafeCols_ = 0;
+
+        // Two horizontally resized source rows, each is 3 planes of output width.
+        std::vector<float> rowsCache_;
+        int cachedRows_[2] = { -1, -1 };
+        int evictNext_ = 0;
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace detect {
+    struct Detection {
+        cv::Rect box;
+        float confidence;
+    };
+
+    using Detections = std::vector<Detection>;
+}
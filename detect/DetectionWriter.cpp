@@ -0,0 +1,43 @@
+#include "DetectionWriter.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace detect {
+    DetectionWriter::DetectionWriter(const std::string &path)
+        : file_(path == "-" ? stdout : std::fopen(path.c_str(), "wb")), ownsFile_(path != "-") {
+        if (!file_) throw std::runtime_error("Could not open '" + path + "' to write detections.");
+    }
+
+    DetectionWriter::~DetectionWriter() {
+        if (ownsFile_) std::fclose(file_);
+        else std::fflush(file_);
+    }
+
+    void DetectionWriter::write(size_t streamId, uint64_t sequence, std::chrono::steady_clock::time_point captured,
+            bool detected, const std::vector<Track> &tracks) {
+        // Steady clock has no epoch, the capture time is carried over to the wall clock.
+        const auto steadyNow = std::chrono::steady_clock::now();
+        const auto age = steadyNow - captured;
+        const double capturedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::system_clock::now().time_since_epoch() - age).count();
+        const double latencyMs = std::chrono::duration<double, std::milli>(age).count();
+
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer),
+                "{\"stream\":%zu,\"sequence\":%llu,\"time\":%.1f,\"latencyMs\":%.1f,\"detected\":%s,\"boxes\":[",
+                streamId, static_cast<unsigned long long>(sequence), capturedMs, latencyMs, detected ? "true" : "false");
+        line_ = buffer;
+        for (size_t i = 0; i < tracks.size(); i++) {
+            const cv::Rect box = tracks[i].rect();
+            std::snprintf(buffer, sizeof(buffer), "%s{\"id\":%d,\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d,\"confidence\":%.3f}",
+                    i ? "," : "", tracks[i].id, box.x, box.y, box.width, box.height, tracks[i].confidence);
+            line_ += buffer;
+        }
+        line_ += "]}\n";
+
+        if (std::fwrite(line_.data(), 1, line_.size(), file_) != line_.size() || std::fflush(file_) != 0)
+            throw std::runtime_error("Could not write detections.");
+        written_++;
+    }
+}
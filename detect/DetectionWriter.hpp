@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Tracker.hpp"
+
+namespace detect {
+    // Writes the boxes of every processed frame as one JSON object per line:
+    // {"stream":0,"sequence":42,"time":1634480000123.4,"latencyMs":41.2,
+    //  "detected":true,"boxes":[{"id":3,"x":10,"y":20,"w":64,"h":80,"confidence":0.97}]}
+    // time is the capture time in Unix milliseconds, latencyMs how long after
+    // capture the line was written. Every line is flushed, so readers on the
+    // other end of a pipe see frames as they come. One writing thread.
+    class DetectionWriter {
+    public:
+        // "-" is stdout, anything else a file which is truncated. Throws if the
+        // file can't be opened.
+        explicit DetectionWriter(const std::string &path);
+        DetectionWriter(const DetectionWriter &) = delete;
+        DetectionWriter &operator=(const DetectionWriter &) = delete;
+        ~DetectionWriter();
+
+        // detected is false for frames whose boxes were only predicted. Throws
+        // if the line could not be written, e.g. the reader went away.
+        void write(size_t streamId, uint64_t sequence, std::chrono::steady_clock::time_point captured,
+                bool detected, const std::vector<Track> &tracks);
+
+        uint64_t written() const { return written_; }
+
+    private:
+        std::FILE *file_ = nullptr;
+        const bool ownsFile_;
+        std::string line_;
+        uint64_t written_ = 0;
+    };
+}
@@ -0,0 +1,101 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace detect {
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string &path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Can't open '" + path + "'.");
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Can't get size of '" + path + "'.");
+        }
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        // Empty files can't be mapped, they stay with a null data pointer.
+        if (size_ != 0) {
+            mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+        // The mapping keeps the file open on its own.
+        CloseHandle(file);
+        if (size_ != 0 && !data_) {
+            this->unmap();
+            throw std::runtime_error("Can't map '" + path + "' to memory.");
+        }
+    }
+
+    void MappedFile::unmap() {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        size_ = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error("Can't open '" + path + "'.");
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Can't get size of '" + path + "'.");
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        // Empty files can't be mapped, they stay with a null data pointer.
+        if (size_ != 0) {
+            void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data_ = static_cast<const char *>(mapped);
+                // Parsers read the whole file right away, start reading it ahead.
+                ::madvise(mapped, size_, MADV_WILLNEED);
+            }
+        }
+        // The mapping keeps the file open on its own.
+        ::close(fd);
+        if (size_ != 0 && !data_)
+            throw std::runtime_error("Can't map '" + path + "' to memory.");
+    }
+
+    void MappedFile::unmap() {
+        if (data_) ::munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#endif
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            this->unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile() { this->unmap(); }
+}
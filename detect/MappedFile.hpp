@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace detect {
+    // Read-only memory mapping of a whole file. Pages are loaded on first
+    // access, so nothing is copied through stream buffers.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path);
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile();
+
+        const char *data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        void unmap();
+
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void *mapping_ = nullptr;
+#endif
+    };
+}
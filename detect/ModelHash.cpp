@@ -0,0 +1,23 @@
+#include "ModelHash.hpp"
+
+#include <cstdio>
+
+namespace detect {
+    uint64_t fnv1a(const void *data, size_t size, uint64_t seed) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    std::string hashToString(uint64_t hash) {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+
+        return buf;
+    }
+}
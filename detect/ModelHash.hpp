@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace detect {
+    const uint64_t FNV1A_OFFSET = 0xcbf29ce484222325ull;
+
+    // 64-bit FNV-1a, pass the previous result as seed to hash data in pieces.
+    uint64_t fnv1a(const void *data, size_t size, uint64_t seed = FNV1A_OFFSET);
+    // Fixed width hex form used as a key in cache files.
+    std::string hashToString(uint64_t hash);
+}
@@ -0,0 +1,173 @@
+#include "ModelLoader.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "ModelHash.hpp"
+
+namespace detect {
+    namespace {
+        const char BUNDLE_MAGIC[4] = { 'G', 'B', 'M', 'B' };
+        const uint32_t BUNDLE_VERSION = 2u;
+
+        struct BundleHeader {
+            char magic[4];
+            uint32_t version;
+            // Identifies the original files, see fileKey().
+            uint64_t key;
+            // Of the original contents, handed out as LoadedModel::hash.
+            uint64_t hash;
+            uint64_t prototxtSize;
+            uint64_t weightsSize;
+        };
+
+        // Path, size and modification time of the files, so a warm start finds
+        // its bundle without reading the originals. Replacing a file with
+        // another of the same size and time stamp goes unnoticed.
+        uint64_t fileKey(const std::vector<std::string> &paths) {
+            uint64_t key = FNV1A_OFFSET;
+            for (const std::string &path : paths) {
+                const std::string absolute = std::filesystem::absolute(path).lexically_normal().string();
+                const uint64_t size = std::filesystem::file_size(path);
+                const int64_t modified = std::filesystem::last_write_time(path).time_since_epoch().count();
+                key = fnv1a(absolute.data(), absolute.size() + 1, key);
+                key = fnv1a(&size, sizeof(size), key);
+                key = fnv1a(&modified, sizeof(modified), key);
+            }
+
+            return key;
+        }
+
+        std::filesystem::path bundlePath(const std::string &cacheDir, uint64_t key) {
+            return std::filesystem::path(cacheDir) / (hashToString(key) + ".gbmodel");
+        }
+
+        // Returns the bundle only if it is complete and made from the same files.
+        std::optional<MappedFile> openBundle(const std::filesystem::path &path, uint64_t key) {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(path, error)) return std::nullopt;
+
+            MappedFile bundle(path.string());
+            BundleHeader header;
+            if (bundle.size() < sizeof(header)) return std::nullopt;
+
+            std::memcpy(&header, bundle.data(), sizeof(header));
+            const bool valid = std::memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) == 0 &&
+                header.version == BUNDLE_VERSION && header.key == key &&
+                bundle.size() == sizeof(header) + header.prototxtSize + header.weightsSize;
+            if (!valid) return std::nullopt;
+
+            return bundle;
+        }
+
+        void writeBundle(const std::filesystem::path &path, uint64_t key, uint64_t hash, const std::string &prototxt,
+                const MappedFile &weights) {
+            std::filesystem::create_directories(path.parent_path());
+
+            BundleHeader header = {};
+            std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+            header.version = BUNDLE_VERSION;
+            header.key = key;
+            header.hash = hash;
+            header.prototxtSize = prototxt.size();
+            header.weightsSize = weights.size();
+
+            // Written aside and renamed, so a restart in the middle never finds
+            // a half written bundle.
+            std::filesystem::path partial = path;
+            partial += ".partial";
+            {
+                std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                file.write(prototxt.data(), static_cast<std::streamsize>(prototxt.size()));
+                file.write(weights.data(), static_cast<std::streamsize>(weights.size()));
+                if (!file)
+                    throw std::runtime_error("Can't write model bundle '" + partial.string() + "'.");
+            }
+            std::filesystem::rename(partial, path);
+        }
+    }
+
+    LoadedModel loadCaffeModel(const std::string &prototxtPath, const std::string &weightsPath,
+            const std::string &cacheDir) {
+        LoadedModel loaded;
+        std::filesystem::path path;
+        uint64_t key = 0;
+        if (!cacheDir.empty()) {
+            key = fileKey({ prototxtPath, weightsPath });
+            path = bundlePath(cacheDir, key);
+            if (std::optional<MappedFile> bundle = openBundle(path, key)) {
+                BundleHeader header;
+                std::memcpy(&header, bundle->data(), sizeof(header));
+                const char *bundledPrototxt = bundle->data() + sizeof(header);
+                loaded.net = cv::dnn::readNetFromCaffe(bundledPrototxt, static_cast<size_t>(header.prototxtSize),
+                        bundledPrototxt + header.prototxtSize, static_cast<size_t>(header.weightsSize));
+                loaded.hash = header.hash;
+                loaded.fromCache = true;
+
+                return loaded;
+            }
+        }
+
+        const MappedFile prototxt(prototxtPath);
+        const MappedFile weights(weightsPath);
+        loaded.hash = fnv1a(weights.data(), weights.size(), fnv1a(prototxt.data(), prototxt.size()));
+
+        if (!cacheDir.empty()) {
+            const std::string compacted = compactPrototxt(prototxt.data(), prototxt.size());
+            loaded.net = cv::dnn::readNetFromCaffe(compacted.data(), compacted.size(),
+                    weights.data(), weights.size());
+            try {
+                writeBundle(path, key, loaded.hash, compacted, weights);
+            }
+            catch (const std::exception &e) {
+                loaded.cacheError = e.what();
+            }
+
+            return loaded;
+        }
+
+        loaded.net = cv::dnn::readNetFromCaffe(prototxt.data(), prototxt.size(), weights.data(), weights.size());
+
+        return loaded;
+    }
+
+    std::string compactPrototxt(const char *text, size_t size) {
+        std::string compacted;
+        compacted.reserve(size);
+        bool pendingSpace = false;
+        for (size_t i = 0; i < size; i++) {
+            const char c = text[i];
+            if (c == '#') {
+                while (i < size && text[i] != '\n') i++;
+                pendingSpace = true;
+            }
+            else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                pendingSpace = true;
+            }
+            else if (c == '"' || c == '\'') {
+                if (pendingSpace && !compacted.empty()) compacted.push_back(' ');
+                pendingSpace = false;
+                // Copies the string with its quotes, escaped quotes included.
+                compacted.push_back(c);
+                for (i++; i < size && text[i] != c; i++) {
+                    compacted.push_back(text[i]);
+                    if (text[i] == '\\' && i + 1 < size) compacted.push_back(text[++i]);
+                }
+                if (i < size) compacted.push_back(c);
+            }
+            else {
+                if (pendingSpace && !compacted.empty()) compacted.push_back(' ');
+                pendingSpace = false;
+                compacted.push_back(c);
+            }
+        }
+
+        return compacted;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/dnn.hpp>
+
+namespace detect {
+    struct LoadedModel {
+        cv::dnn::Net net;
+        // FNV-1a of the prototxt and weights contents, see ModelHash.hpp. Taken
+        // from the bundle when loaded from it.
+        uint64_t hash = 0;
+        bool fromCache = false;
+        // Why the bundle could not be written, the net is loaded anyway.
+        std::string cacheError;
+    };
+
+    // Reads a Caffe model from memory mapped files instead of streams. If
+    // cacheDir is not empty the model is also kept there as one bundle file
+    // holding the prototxt with comments and indentation stripped followed by
+    // the weights. The bundle is named after the paths, sizes and modification
+    // times of the files, so later loads read only the bundle.
+    LoadedModel loadCaffeModel(const std::string &prototxtPath, const std::string &weightsPath,
+            const std::string &cacheDir = "");
+
+    // Drops comments and collapses whitespace of a protobuf text file, quoted
+    // strings are kept as they are.
+    std::string compactPrototxt(const char *text, size_t size);
+}
@@ -0,0 +1,58 @@
+#include "MotionGate.hpp"
+
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+namespace detect {
+    namespace {
+        // Weight of the newest thumbnail in the running background.
+        const float BACKGROUND_RATE = 0.05f;
+    }
+
+    MotionGate::MotionGate(const MotionGateSettings &settings, cv::Size thumbnailSize)
+        : settings_(settings), thumbnailSize_(thumbnailSize) {}
+
+    bool MotionGate::admit(const cv::Mat &frame) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const bool first = background_.empty();
+        const float energy = this->measure(frame);
+        energy_.store(energy, std::memory_order_relaxed);
+        checked_.fetch_add(1, std::memory_order_relaxed);
+
+        const std::chrono::milliseconds keepalive(settings_.keepaliveMs.load(std::memory_order_relaxed));
+        const bool pass = first || energy >= settings_.energyThreshold.load(std::memory_order_relaxed) ||
+                now - lastAdmitted_ >= keepalive;
+        if (pass) {
+            lastAdmitted_ = now;
+            admitted_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return pass;
+    }
+
+    float MotionGate::measure(const cv::Mat &frame) {
+        // INTER_AREA averages the pixels away, so sensor noise does not count as motion.
+        cv::resize(frame, thumbnail_, thumbnailSize_, 0.0, 0.0, cv::INTER_AREA);
+
+        const size_t pixels = static_cast<size_t>(thumbnailSize_.area());
+        const bool first = background_.size() != pixels;
+        if (first) background_.assign(pixels, 0.0f);
+
+        const float pixelThreshold = static_cast<float>(settings_.pixelThreshold.load(std::memory_order_relaxed));
+        size_t changed = 0;
+        for (int y = 0; y < thumbnail_.rows; y++) {
+            const unsigned char *row = thumbnail_.ptr(y);
+            float *background = background_.data() + static_cast<size_t>(y) * thumbnail_.cols;
+            for (int x = 0; x < thumbnail_.cols; x++) {
+                const unsigned char *bgr = row + 3 * x;
+                const float gray = (29.0f * bgr[0] + 150.0f * bgr[1] + 77.0f * bgr[2]) / 256.0f;
+                if (first) background[x] = gray;
+                if (std::fabs(gray - background[x]) > pixelThreshold) changed++;
+                background[x] += BACKGROUND_RATE * (gray - background[x]);
+            }
+        }
+
+        return static_cast<float>(changed) / static_cast<float>(pixels);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace detect {
+    // Tunables shared by the gates of all streams, may be changed from any thread.
+    struct MotionGateSettings {
+        // Fraction of thumbnail pixels which have to change to let a frame through.
+        std::atomic<float> energyThreshold = 0.01f;
+        // Gray level difference from the background counted as a changed pixel.
+        std::atomic_int pixelThreshold = 16;
+        // A frame is let through at least this often even if nothing moves.
+        std::atomic_int keepaliveMs = 2000;
+    };
+
+    // Cheap check whether a frame is worth running the detector on. Every frame
+    // is shrunk to a small gray thumbnail and compared against a slowly updated
+    // background, the share of differing pixels is the motion energy.
+    // admit() is meant for a single thread, the statistics can be read from any.
+    class MotionGate {
+    public:
+        explicit MotionGate(const MotionGateSettings &settings, cv::Size thumbnailSize = cv::Size(64, 48));
+        MotionGate(const MotionGate &) = delete;
+        MotionGate &operator=(const MotionGate &) = delete;
+
+        bool admit(const cv::Mat &frame);
+
+        float energy() const { return energy_.load(std::memory_order_relaxed); }
+        uint64_t checked() const { return checked_.load(std::memory_order_relaxed); }
+        uint64_t admitted() const { return admitted_.load(std::memory_order_relaxed); }
+
+    private:
+        float measure(const cv::Mat &frame);
+
+        const MotionGateSettings &settings_;
+        const cv::Size thumbnailSize_;
+        cv::Mat thumbnail_;
+        std::vector<float> background_;
+        std::chrono::steady_clock::time_point lastAdmitted_;
+
+        std::atomic<float> energy_ = 0.0f;
+        std::atomic_uint64_t checked_ = 0;
+        std::atomic_uint64_t admitted_ = 0;
+    };
+}
@@ -0,0 +1,96 @@
+#include "RoiPlanner.hpp"
+
+#include <algorithm>
+
+#include <opencv2/dnn.hpp>
+
+namespace detect {
+    namespace {
+        // Square of the given side around center, shifted to lie inside the frame.
+        cv::Rect squareInside(cv::Point center, int side, cv::Size frameSize) {
+            const int w = std::min(side, frameSize.width);
+            const int h = std::min(side, frameSize.height);
+            const int x = std::clamp(center.x - w / 2, 0, frameSize.width - w);
+            const int y = std::clamp(center.y - h / 2, 0, frameSize.height - h);
+
+            return cv::Rect(x, y, w, h);
+        }
+
+        bool mostlyInside(const cv::Rect &inner, const cv::Rect &outer) {
+            return (inner & outer).area() * 10 >= inner.area() * 7;
+        }
+    }
+
+    std::vector<cv::Rect> RoiPlanner::plan(cv::Size frameSize, const std::vector<cv::Rect> &known) {
+        std::vector<cv::Rect> boxes = known;
+        std::sort(boxes.begin(), boxes.end(), [](const cv::Rect &a, const cv::Rect &b) {
+            return a.area() < b.area();
+        });
+
+        std::vector<cv::Rect> rois;
+        for (const cv::Rect &box : boxes) {
+            if (rois.size() >= params_.maxRois) break;
+
+            const int side = std::max(params_.minSide,
+                    static_cast<int>(params_.context * std::max(box.width, box.height)));
+            const cv::Point center(box.x + box.width / 2, box.y + box.height / 2);
+            const cv::Rect roi = squareInside(center, side, frameSize);
+            if (roi.area() * 2 > frameSize.area()) continue;
+
+            const bool covered = std::any_of(rois.cbegin(), rois.cend(),
+                    [&roi](const cv::Rect &other) { return mostlyInside(roi, other); });
+            if (!covered) rois.push_back(roi);
+        }
+
+        if (params_.sweepEvery > 0 && ++plans_ >= params_.sweepEvery) {
+            plans_ = 0;
+            this->prepareTiles(frameSize);
+            if (!tiles_.empty()) {
+                rois.push_back(tiles_[nextTile_]);
+                nextTile_ = (nextTile_ + 1) % tiles_.size();
+            }
+        }
+
+        return rois;
+    }
+
+    void RoiPlanner::prepareTiles(cv::Size frameSize) {
+        if (frameSize.width == tilesFrameSize_.width && frameSize.height == tilesFrameSize_.height) return;
+
+        // Square tiles of half the shorter frame side overlapping by a quarter,
+        // so a face cut by one tile border is whole in the neighbour.
+        tiles_.clear();
+        nextTile_ = 0;
+        tilesFrameSize_ = frameSize;
+        const int side = std::min(frameSize.width, frameSize.height) / 2;
+        if (side <= 0) return;
+
+        const int stride = side * 3 / 4;
+        for (int y = 0;; y += stride) {
+            const int top = std::min(y, frameSize.height - side);
+            for (int x = 0;; x += stride) {
+                const int left = std::min(x, frameSize.width - side);
+                tiles_.emplace_back(left, top, side, side);
+                if (left + side >= frameSize.width) break;
+            }
+            if (top + side >= frameSize.height) break;
+        }
+    }
+
+    Detections mergeDetections(const Detections &detections, float maxOverlap) {
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        for (const Detection &d : detections) {
+            boxes.push_back(d.box);
+            scores.push_back(d.confidence);
+        }
+
+        std::vector<int> kept;
+        cv::dnn::NMSBoxes(boxes, scores, 0.0f, maxOverlap, kept);
+
+        Detections merged;
+        for (int i : kept) merged.push_back(detections[i]);
+
+        return merged;
+    }
+}
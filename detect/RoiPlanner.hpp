@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Detection.hpp"
+
+namespace detect {
+    // Picks crops of a frame which are detected in the same batch as the whole
+    // frame. Squashing a full frame into the net input leaves distant faces a few
+    // pixels wide, a crop around a known box or a sweep tile shows them bigger
+    // for the price of one more batch image.
+    class RoiPlanner {
+    public:
+        struct Params {
+            // Crop side relative to the larger side of a known box.
+            float context = 3.0f;
+            // Crops are at least this large, smaller ones would only upscale pixels.
+            int minSide = 160;
+            size_t maxRois = 4;
+            // One sweep tile is added to every N-th plan, 0 disables the sweep.
+            int sweepEvery = 0;
+        };
+
+        RoiPlanner() : RoiPlanner(Params()) {}
+        explicit RoiPlanner(const Params &params) : params_(params) {}
+
+        // Most crops a plan with these parameters can hold.
+        static size_t maxCrops(const Params &params) { return params.maxRois + (params.sweepEvery > 0 ? 1u : 0u); }
+
+        // Crops around the known boxes, smallest boxes first, plus the next sweep
+        // tile when it is due. Crops which would cover most of the frame anyway
+        // are left out.
+        std::vector<cv::Rect> plan(cv::Size frameSize, const std::vector<cv::Rect> &known);
+
+    private:
+        void prepareTiles(cv::Size frameSize);
+
+        const Params params_;
+        cv::Size tilesFrameSize_;
+        std::vector<cv::Rect> tiles_;
+        size_t nextTile_ = 0;
+        int plans_ = 0;
+    };
+
+    // Non-maximum suppression of detections coming from overlapping regions.
+    Detections mergeDetections(const Detections &detections, float maxOverlap);
+}
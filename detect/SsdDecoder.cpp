@@ -0,0 +1,40 @@
+#include "SsdDecoder.hpp"
+
+namespace detect {
+    std::vector<Detections> decodeSsdOutput(const cv::Mat &output, const std::vector<cv::Size> &frameSizes,
+            float minConfidence) {
+        std::vector<Detections> decoded(frameSizes.size());
+        if (output.empty()) return decoded;
+
+        // As far as I understood, cv::Mat::size represents:
+        // size[0] - mat rows
+        // size[1] - mat columns
+        // size[2] - mat depth
+        // size[3] - something like data per detection (especially for detections
+        // produced by cv::Net)
+        const int rows = output.size[2];
+        const int cols = output.size[3];
+        const float *data = output.ptr<float>();
+
+        for (int i = 0; i < rows; i++) {
+            const float *row = data + static_cast<size_t>(i) * cols;
+            const float confidence = row[2];
+            const size_t imageId = static_cast<size_t>(row[0]);
+
+            if (confidence >= minConfidence && imageId < frameSizes.size()) {
+                const cv::Size frameSize = frameSizes[imageId];
+                const int xLeftBottom = static_cast<int>(row[3] * frameSize.width);
+                const int yLeftBottom = static_cast<int>(row[4] * frameSize.height);
+                const int xRightTop = static_cast<int>(row[5] * frameSize.width);
+                const int yRightTop = static_cast<int>(row[6] * frameSize.height);
+
+                decoded[imageId].push_back({
+                    cv::Rect(xLeftBottom, yLeftBottom, xRightTop - xLeftBottom, yRightTop - yLeftBottom),
+                    confidence
+                });
+            }
+        }
+
+        return decoded;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Detection.hpp"
+
+namespace detect {
+    // Turns the DetectionOutput blob of the SSD into boxes in frame pixels.
+    // The blob has shape [1, 1, N, 7] and each row holds
+    // [image id, label, confidence, left, top, right, bottom] with coordinates
+    // relative to the image. Results are grouped by image id, frameSizes holds
+    // the size of every image in the batch.
+    std::vector<Detections> decodeSsdOutput(const cv::Mat &output, const std::vector<cv::Size> &frameSizes,
+            float minConfidence);
+}
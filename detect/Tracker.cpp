@@ -0,0 +1,113 @@
+#include "Tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace detect {
+    namespace {
+        float iou(const cv::Rect2f &a, const cv::Rect2f &b) {
+            const float intersection = (a & b).area();
+            const float united = a.area() + b.area() - intersection;
+
+            return united > 0.0f ? intersection / united : 0.0f;
+        }
+
+        cv::Rect2f toRect2f(const cv::Rect &r) {
+            return cv::Rect2f(static_cast<float>(r.x), static_cast<float>(r.y),
+                    static_cast<float>(r.width), static_cast<float>(r.height));
+        }
+    }
+
+    cv::Rect Track::rect() const {
+        return cv::Rect(static_cast<int>(std::lround(box.x)), static_cast<int>(std::lround(box.y)),
+                static_cast<int>(std::lround(box.width)), static_cast<int>(std::lround(box.height)));
+    }
+
+    void Tracker::update(const Detections &detections) {
+        for (Track &track : tracks_) this->advance(track);
+
+        // Greedy association, best overlapping pairs first.
+        std::vector<std::tuple<float, size_t, size_t>> pairs;
+        for (size_t t = 0; t < tracks_.size(); t++)
+            for (size_t d = 0; d < detections.size(); d++) {
+                const float overlap = iou(tracks_[t].box, toRect2f(detections[d].box));
+                if (overlap >= params_.matchIou) pairs.emplace_back(overlap, t, d);
+            }
+        std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {
+            return std::get<0>(a) > std::get<0>(b);
+        });
+
+        std::vector<bool> trackMatched(tracks_.size(), false);
+        std::vector<bool> detectionMatched(detections.size(), false);
+        for (const auto &[overlap, t, d] : pairs) {
+            if (trackMatched[t] || detectionMatched[d]) continue;
+            trackMatched[t] = detectionMatched[d] = true;
+
+            Track &track = tracks_[t];
+            const cv::Rect2f measured = toRect2f(detections[d].box);
+            // Measured from the last match, the predicted box may have stopped
+            // short of where the old velocity would have taken it.
+            const cv::Point2f error((measured.x - track.matched.x) / track.framesSinceMatch - track.velocity.x,
+                    (measured.y - track.matched.y) / track.framesSinceMatch - track.velocity.y);
+            track.velocity += error * params_.velocityGain;
+            track.box = track.matched = measured;
+            track.confidence = detections[d].confidence;
+            track.framesSinceMatch = 0;
+            track.misses = 0;
+        }
+
+        for (size_t t = 0; t < tracks_.size(); t++)
+            if (!trackMatched[t]) tracks_[t].misses++;
+        tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                [this](const Track &track) { return this->expired(track); }), tracks_.end());
+
+        for (size_t d = 0; d < detections.size(); d++)
+            if (!detectionMatched[d]) {
+                const cv::Rect2f box = toRect2f(detections[d].box);
+                tracks_.push_back({ nextId_++, box, cv::Point2f(), detections[d].confidence, 0, 0, box });
+            }
+    }
+
+    void Tracker::predict() {
+        for (Track &track : tracks_) this->advance(track);
+        // Without detections a track may not live on forever on its own guess.
+        tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                [this](const Track &track) { return this->expired(track); }), tracks_.end());
+    }
+
+    bool Tracker::needsDetection() const {
+        return std::any_of(tracks_.cbegin(), tracks_.cend(), [this](const Track &track) {
+            // A moving box which stopped following its velocity is where the
+            // person was, not where they are.
+            const bool stale = track.framesSinceMatch >= params_.maxExtrapolated
+                    && std::hypot(track.velocity.x, track.velocity.y) > params_.stillSpeed * track.box.width;
+            return stale || track.confidence < params_.minConfidence;
+        });
+    }
+
+    const Track *Tracker::primary(int preferredId) const {
+        const Track *largest = nullptr;
+        for (const Track &track : tracks_) {
+            if (track.id == preferredId) return &track;
+            if (!largest || track.box.area() > largest->box.area()) largest = &track;
+        }
+
+        return largest;
+    }
+
+    void Tracker::advance(Track &track) const {
+        // Constant velocity is only a fair guess for a short while, a box sliding
+        // on without image evidence would lead the servo away from the face.
+        if (track.framesSinceMatch < params_.maxExtrapolated) {
+            track.box.x += track.velocity.x;
+            track.box.y += track.velocity.y;
+        }
+        track.confidence *= params_.confidenceDecay;
+        track.framesSinceMatch++;
+    }
+
+    bool Tracker::expired(const Track &track) const {
+        return track.misses > params_.maxMisses || track.framesSinceMatch > params_.maxUnmatchedFrames;
+    }
+}
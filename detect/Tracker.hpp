@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Detection.hpp"
+
+namespace detect {
+    struct Track {
+        int id;
+        cv::Rect2f box;
+        // Movement of the box top left corner per frame.
+        cv::Point2f velocity;
+        // Detector confidence of the last match, decayed for every predicted frame.
+        float confidence;
+        int framesSinceMatch;
+        // Detector runs in a row the track was not found in.
+        int misses;
+        // Box of the last match, the velocity is measured from it.
+        cv::Rect2f matched;
+
+        cv::Rect rect() const;
+    };
+
+    // Keeps boxes of one stream alive between detector runs. Detections are
+    // associated to tracks greedily by IoU, frames without detection move every
+    // track along its constant velocity for a few frames, then the box stays
+    // put and the track is dropped if no detection confirms it in time. Track
+    // ids are never reused.
+    class Tracker {
+    public:
+        struct Params {
+            float matchIou = 0.3f;
+            // Detector runs a track may stay unmatched before it is dropped.
+            int maxMisses = 2;
+            float confidenceDecay = 0.97f;
+            // How fast the velocity follows the measured movement, 1 takes it as is.
+            float velocityGain = 0.5f;
+            // Below this the tracks are not trusted anymore and detection is due.
+            float minConfidence = 0.5f;
+            // Frames a track moves along its velocity after its last match.
+            int maxExtrapolated = 15;
+            // Speed per frame, relative to the box width, below which a track
+            // counts as standing still.
+            float stillSpeed = 0.01f;
+            // Frames a track may go without any match before it is dropped.
+            int maxUnmatchedFrames = 45;
+        };
+
+        Tracker() : Tracker(Params()) {}
+        explicit Tracker(const Params &params) : params_(params) {}
+
+        // Frame which went through the detector.
+        void update(const Detections &detections);
+        // Frame which did not, tracks are only propagated.
+        void predict();
+
+        // Some track is not trusted anymore, the next frame should be detected
+        // even if nothing seems to move in it.
+        bool needsDetection() const;
+        // Track to follow: preferredId while it is alive, otherwise the largest
+        // box, i.e. usually the closest person. nullptr if there are no tracks.
+        const Track *primary(int preferredId = -1) const;
+        const std::vector<Track> &tracks() const { return tracks_; }
+
+    private:
+        void advance(Track &track) const;
+        bool expired(const Track &track) const;
+
+        const Params params_;
+        std::vector<Track> tracks_;
+        int nextId_ = 0;
+    };
+}
@@ -0,0 +1,100 @@
+#include "OverlayRenderer.hpp"
+
+#include "glstuff.hpp"
+#include "VertexArrayLayout.hpp"
+
+namespace gl {
+    namespace {
+        const unsigned int FLOATS_PER_RECT = 4;
+        const unsigned int INITIAL_CAPACITY = 16;
+
+        // Outer corners go first, then the same corners of the inner edge.
+        //                              corner      inner
+        const float OUTLINE_VERTICES[] = {
+                                        0.0f, 0.0f, 0.0f,
+                                        1.0f, 0.0f, 0.0f,
+                                        1.0f, 1.0f, 0.0f,
+                                        0.0f, 1.0f, 0.0f,
+                                        0.0f, 0.0f, 1.0f,
+                                        1.0f, 0.0f, 1.0f,
+                                        1.0f, 1.0f, 1.0f,
+                                        0.0f, 1.0f, 1.0f
+        };
+        const unsigned int OUTLINE_FLOATS = sizeof(OUTLINE_VERTICES) / sizeof(float);
+
+        // One quad per side between the outer and the inner edge.
+        const GLuint OUTLINE_INDICES[] = {
+            0, 1, 5,   0, 5, 4,
+            1, 2, 6,   1, 6, 5,
+            2, 3, 7,   2, 7, 6,
+            3, 0, 4,   3, 4, 7
+        };
+        const GLsizei OUTLINE_ELEMENTS = sizeof(OUTLINE_INDICES) / sizeof(GLuint);
+    }
+
+    OverlayRenderer::OverlayRenderer()
+        : mesh_(OUTLINE_VERTICES, OUTLINE_FLOATS, GL_STATIC_DRAW),
+          ib_(OUTLINE_INDICES, OUTLINE_ELEMENTS, GL_STATIC_DRAW),
+          program_(loadOverlayShaders()) {
+        mesh_.bind();
+        VertexArrayLayout meshLayout;
+        meshLayout.addAttribute(2, GL_FLOAT, false);
+        meshLayout.addAttribute(1, GL_FLOAT, false);
+        va_.setLayout(meshLayout);
+
+        instancesCapacity_ = INITIAL_CAPACITY;
+        instances_.setData(nullptr, instancesCapacity_ * FLOATS_PER_RECT, GL_STREAM_DRAW);
+        VertexArrayLayout instanceLayout(static_cast<unsigned int>(meshLayout.attributes.size()), 1);
+        instanceLayout.addAttribute(FLOATS_PER_RECT, GL_FLOAT, false);
+        va_.setLayout(instanceLayout);
+
+        va_.unbind();
+        instances_.unbind();
+    }
+
+    OverlayRenderer::~OverlayRenderer() noexcept {
+        program_.del();
+    }
+
+    void OverlayRenderer::setRects(const std::vector<cv::Rect> &rects) {
+        staging_.clear();
+        for (const cv::Rect &r : rects) {
+            staging_.push_back(static_cast<float>(r.x));
+            staging_.push_back(static_cast<float>(r.y));
+            staging_.push_back(static_cast<float>(r.width));
+            staging_.push_back(static_cast<float>(r.height));
+        }
+        instancesCount_ = static_cast<unsigned int>(rects.size());
+        if (instancesCount_ == 0) return;
+
+        while (instancesCapacity_ < instancesCount_) instancesCapacity_ *= 2;
+        // Orphaning the old storage keeps the driver from waiting for the previous draw.
+        instances_.setData(nullptr, instancesCapacity_ * FLOATS_PER_RECT, GL_STREAM_DRAW);
+        instances_.update(staging_.data(), instancesCount_ * FLOATS_PER_RECT);
+        instances_.unbind();
+    }
+
+    void OverlayRenderer::setColor(float r, float g, float b, float a) {
+        color_[0] = r;
+        color_[1] = g;
+        color_[2] = b;
+        color_[3] = a;
+    }
+
+    void OverlayRenderer::setThickness(float pixels) { thickness_ = pixels; }
+
+    void OverlayRenderer::draw(GLsizei frameWidth, GLsizei frameHeight) const {
+        if (instancesCount_ == 0) return;
+
+        program_.use();
+        program_.setUniform("u_frameSize", static_cast<float>(frameWidth), static_cast<float>(frameHeight));
+        program_.setUniform("u_thickness", thickness_);
+        program_.setUniform("u_color", color_[0], color_[1], color_[2], color_[3]);
+
+        va_.bind();
+        glDrawElementsInstanced(GL_TRIANGLES, OUTLINE_ELEMENTS, GL_UNSIGNED_INT, nullptr,
+                static_cast<GLsizei>(instancesCount_));
+        va_.unbind();
+        program_.stopUse();
+    }
+}
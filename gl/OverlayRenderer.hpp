@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <opencv2/core.hpp>
+
+#include "IndexBuffer.hpp"
+#include "Program.hpp"
+#include "VertexArray.hpp"
+#include "VertexBuffer.hpp"
+
+namespace gl {
+    // Draws rectangle outlines over the frame in a single instanced call.
+    // The outline mesh is uploaded once, rectangles themselves live in a per
+    // instance buffer which is refilled by setRects(). Rectangles are given in
+    // frame pixels, the same space detections are produced in.
+    class OverlayRenderer {
+    public:
+        OverlayRenderer();
+        OverlayRenderer(const OverlayRenderer &) = delete;
+        OverlayRenderer &operator=(const OverlayRenderer &) = delete;
+        ~OverlayRenderer() noexcept;
+
+        void setRects(const std::vector<cv::Rect> &rects);
+        void setColor(float r, float g, float b, float a = 1.0f);
+        void setThickness(float pixels);
+
+        void draw(GLsizei frameWidth, GLsizei frameHeight) const;
+
+    private:
+        VertexArray va_;
+        VertexBuffer<float> mesh_;
+        IndexBuffer<GLuint> ib_;
+        VertexBuffer<float> instances_;
+        Program program_;
+
+        std::vector<float> staging_;
+        unsigned int instancesCount_ = 0;
+        unsigned int instancesCapacity_ = 0;
+        float color_[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+        float thickness_ = 4.0f;
+    };
+}
@@ -35,6 +35,21 @@ namespace gl {
 
         return res;
     }
+    GLint Program::getUniformLocation(const std::string &name) const {
+        return glGetUniformLocation(id, name.c_str());
+    }
+    void Program::setUniform(const std::string &name, int value) const {
+        glProgramUniform1i(id, this->getUniformLocation(name), value);
+    }
+    void Program::setUniform(const std::string &name, float value) const {
+        glProgramUniform1f(id, this->getUniformLocation(name), value);
+    }
+    void Program::setUniform(const std::string &name, float x, float y) const {
+        glProgramUniform2f(id, this->getUniformLocation(name), x, y);
+    }
+    void Program::setUniform(const std::string &name, float x, float y, float z, float w) const {
+        glProgramUniform4f(id, this->getUniformLocation(name), x, y, z, w);
+    }
     void Program::del() const {
         glUseProgram(0);
         glDeleteProgram(id);
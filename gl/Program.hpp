@@ -19,6 +19,12 @@ namespace gl {
         void del() const;
         std::string getInfoLog() const;
 
+        GLint getUniformLocation(const std::string &name) const;
+        void setUniform(const std::string &name, int value) const;
+        void setUniform(const std::string &name, float value) const;
+        void setUniform(const std::string &name, float x, float y) const;
+        void setUniform(const std::string &name, float x, float y, float z, float w) const;
+
         GLuint getID() const;
 
     private:
@@ -0,0 +1,81 @@
+#include "StreamingTexture.hpp"
+
+#include <cstring>
+#include <iostream>
+
+namespace gl {
+    namespace {
+        const GLsizeiptr BYTES_PER_PIXEL = 3;
+    }
+
+    StreamingTexture::StreamingTexture(GLsizei width, GLsizei height, GLenum pixelFormat, unsigned int buffersCount)
+        : texture_(GL_TEXTURE_2D), width_(width), height_(height), pixelFormat_(pixelFormat),
+          bufferSize_(static_cast<GLsizeiptr>(width) * height * BYTES_PER_PIXEL),
+          pbos_(buffersCount, 0), fences_(buffersCount, nullptr) {
+        glTexStorage2D(texture_.getType(), 1, GL_RGB8, width_, height_);
+        texture_.unbind();
+
+        glGenBuffers(static_cast<GLsizei>(pbos_.size()), pbos_.data());
+        for (GLuint pbo : pbos_) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize_, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    StreamingTexture::~StreamingTexture() noexcept {
+        for (GLsync fence : fences_)
+            if (fence) glDeleteSync(fence);
+        glDeleteBuffers(static_cast<GLsizei>(pbos_.size()), pbos_.data());
+    }
+
+    bool StreamingTexture::upload(const cv::Mat &image) {
+        if (image.empty()) {
+            std::cerr << "Image is empty.\n";
+            return false;
+        }
+        if (image.type() != CV_8UC3 || image.cols != width_ || image.rows != height_) {
+            std::cerr << "Image does not match streaming texture format.\n";
+            return false;
+        }
+
+        GLsync &fence = fences_[next_];
+        if (fence) {
+            // Zero timeout only polls the fence, the previous transfer from this
+            // buffer is still running if it has not signaled yet.
+            const GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) return false;
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[next_]);
+        auto *mapped = static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize_,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return false;
+        }
+
+        const size_t rowSize = static_cast<size_t>(width_) * BYTES_PER_PIXEL;
+        if (image.isContinuous()) {
+            std::memcpy(mapped, image.data, rowSize * height_);
+        }
+        else {
+            for (int row = 0; row < height_; row++)
+                std::memcpy(mapped + row * rowSize, image.ptr(row), rowSize);
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        texture_.bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(texture_.getType(), 0, 0, 0, width_, height_, pixelFormat_, GL_UNSIGNED_BYTE, nullptr);
+        texture_.unbind();
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        next_ = (next_ + 1) % pbos_.size();
+
+        return true;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <opencv2/core.hpp>
+
+#include "Texture.hpp"
+
+namespace gl {
+    // 2D texture for continuously changing frames of the same size.
+    // Storage is allocated once with glTexStorage2D and every frame goes through
+    // one of several pixel unpack buffers, so glTexSubImage2D is sourced from GPU
+    // memory and the render thread does not wait for the transfer to finish.
+    // A buffer is reused only after its fence has signaled, if none is free the
+    // frame is skipped instead of stalling.
+    // Frames are copied as is: orientation and channel order are left to the
+    // shader, by default BGR data lands in the RGB channels untouched.
+    class StreamingTexture {
+    public:
+        StreamingTexture(GLsizei width, GLsizei height, GLenum pixelFormat = GL_RGB, unsigned int buffersCount = 3u);
+        StreamingTexture(const StreamingTexture &) = delete;
+        StreamingTexture &operator=(const StreamingTexture &) = delete;
+        ~StreamingTexture() noexcept;
+
+        // Accepts 8-bit 3-channel images matching the storage size, returns false
+        // if the frame has not been scheduled for upload.
+        bool upload(const cv::Mat &image);
+
+        template <typename Attr>
+        void setAttr(GLenum attr, Attr val) {
+            texture_.bind();
+            texture_.setAttr(attr, val);
+        }
+
+        GLsizei getWidth() const { return width_; }
+        GLsizei getHeight() const { return height_; }
+        void bind() const { texture_.bind(); }
+        void unbind() const { texture_.unbind(); }
+
+    private:
+        Texture texture_;
+        const GLsizei width_;
+        const GLsizei height_;
+        const GLenum pixelFormat_;
+        const GLsizeiptr bufferSize_;
+        std::vector<GLuint> pbos_;
+        std::vector<GLsync> fences_;
+        size_t next_ = 0;
+    };
+}
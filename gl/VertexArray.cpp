@@ -17,6 +17,7 @@ namespace gl {
         for (auto [index, count, type, norm] : l.attributes) {
             glVertexAttribPointer(index, count, type, norm, l.stride, (const void *)pointer);
             pointer += count * retrieveTypeSize(type);
+            if (l.divisor != 0) glVertexAttribDivisor(index, l.divisor);
             this->enableAttribute(index);
         }
     }
@@ -12,11 +12,16 @@ namespace gl {
     class VertexArrayLayout {
     public:
         VertexArrayLayout() = default;
+        // Layout for a second buffer of the same vertex array: attribute indexes
+        // continue from firstIndex, non-zero divisor makes attributes per instance.
+        explicit VertexArrayLayout(unsigned int firstIndex, unsigned int divisor = 0)
+            : divisor(divisor), indexesCounter(firstIndex) {}
 
         void addAttribute(unsigned int count, GLenum type, bool normalized);
 
         std::vector<Attribute> attributes;
         unsigned int stride = 0;
+        unsigned int divisor = 0;
     private:
         unsigned int indexesCounter = 0;
     };
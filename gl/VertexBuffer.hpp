@@ -19,6 +19,16 @@ namespace gl {
             this->unbind();
         }
 
+        // Reallocates storage, pass nullptr to only reserve count items.
+        void setData(const T *data, unsigned int count, GLenum usage) {
+            this->bind();
+            glBufferData(GL_ARRAY_BUFFER, count * sizeof(T), data, usage);
+        }
+        void update(const T *data, unsigned int count, unsigned int offset = 0) {
+            this->bind();
+            glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(T), count * sizeof(T), data);
+        }
+
         void bind() const {
             glBindBuffer(GL_ARRAY_BUFFER, id);
         }
@@ -2,8 +2,10 @@
 
 #include "glstuff.hpp"
 #include "IndexBuffer.hpp"
+#include "OverlayRenderer.hpp"
 #include "Program.hpp"
 #include "Shader.hpp"
+#include "StreamingTexture.hpp"
 #include "Texture.hpp"
 #include "VertexArray.hpp"
 #include "VertexBuffer.hpp"
\ No newline at end of file
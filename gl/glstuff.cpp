@@ -1,5 +1,6 @@
 #include "glstuff.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -25,18 +26,27 @@ namespace gl {
         return wnd;
     }
 
+    void fitWindow(GLFWwindow *wnd, uint64_t width, uint64_t height) {
+        const GLFWvidmode *vmode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        const uint64_t actualWidth = std::min(width, static_cast<uint64_t>(vmode->width));
+        const uint64_t actualHeight = std::min(height, static_cast<uint64_t>(vmode->height));
+        glfwSetWindowSize(wnd, static_cast<int>(actualWidth), static_cast<int>(actualHeight));
+    }
+
     void loadCVmat2GLTexture(const Texture &tex, const cv::Mat& image, bool shouldFlip)
     {
-        const cv::Mat copied = image.clone();
-        if(copied.empty()) std::cerr << "Image is empty.\n";
+        if(image.empty()) std::cerr << "Image is empty.\n";
         else
         {
             tex.bind();
 
-            cv::Mat processed;
-            if (shouldFlip) cv::flip(copied, processed, 0);
-            else copied.copyTo(processed);
-            
+            // Prefer flipping in the shader (u_flipY), this path costs a full frame copy.
+            cv::Mat flipped;
+            if (shouldFlip) cv::flip(image, flipped, 0);
+            const cv::Mat &processed = shouldFlip ? flipped : image;
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(processed.step[0] / processed.elemSize()));
             glTexImage2D(tex.getType(),
                         0,
                         GL_RGB,
@@ -47,17 +57,18 @@ namespace gl {
                         GL_UNSIGNED_BYTE,
                         processed.data
             );
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
             tex.unbind();
         }
     }
 
-    Program loadDefaultShaders() {
+    Program loadShaders(const std::string &vertexPath, const std::string &fragmentPath) {
         namespace fs = std::filesystem;
-        const fs::path vertfp = fs::path("resources/VertexDefault.shader");
+        const fs::path vertfp = fs::path(vertexPath);
         Shader vertex(ShaderType::Vertex, Shader::parseFromFile(vertfp.string()));
         const bool isVertexReady = vertex.compile();
 
-        const fs::path fragfp = fs::path("resources/FragmentDefault.shader");
+        const fs::path fragfp = fs::path(fragmentPath);
         Shader frag(ShaderType::Fragment, Shader::parseFromFile(fragfp.string()));
         const bool isFragReady = frag.compile();
 
@@ -71,11 +82,20 @@ namespace gl {
         std::clog << p.getInfoLog() << '\n';
         const bool isProgReady = v && li;
 
-        if (!(isVertexReady && isFragReady && isProgReady)) throw std::runtime_error("Default shaders could not be loaded.");
+        if (!(isVertexReady && isFragReady && isProgReady))
+            throw std::runtime_error("Shaders '" + vertexPath + "' and '" + fragmentPath + "' could not be loaded.");
 
         return p;
     }
 
+    Program loadDefaultShaders() {
+        return loadShaders("resources/VertexDefault.shader", "resources/FragmentDefault.shader");
+    }
+
+    Program loadOverlayShaders() {
+        return loadShaders("resources/VertexOverlay.shader", "resources/FragmentOverlay.shader");
+    }
+
     GLuint retrieveTypeSize(GLenum type) {
         GLuint ret = 0;
         switch(type) {
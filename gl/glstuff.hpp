@@ -12,7 +12,11 @@
 namespace gl {
     class Texture;
     GLFWwindow * createDefaultWindow(const std::string &windowName, uint64_t width, uint64_t height);
+    // Resizes the window, no larger than the primary monitor.
+    void fitWindow(GLFWwindow *wnd, uint64_t width, uint64_t height);
     void loadCVmat2GLTexture(const Texture &texture, const cv::Mat &image, bool shouldFlip = false);
+    Program loadShaders(const std::string &vertexPath, const std::string &fragmentPath);
     Program loadDefaultShaders();
+    Program loadOverlayShaders();
     GLuint retrieveTypeSize(GLenum type);
 }
\ No newline at end of file
@@ -1,16 +1,23 @@
-#ifndef GUID_DEVINTERFACE_USB_DEVICE
+#if defined(_WIN32) && !defined(GUID_DEVINTERFACE_USB_DEVICE)
 #include <initguid.h>
 #include <usbiodef.h>
 #endif
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
 #include <iostream>
 #include <thread>
 #include <memory>
-#include <queue>
+#include <numeric>
+#include <optional>
+
+#include "trace/Trace.hpp"
 
 #ifdef PROFILING
-#define BUILD_WITH_EASY_PROFILER
-#include <easy/profiler.h>
 #define PROFILER_CALL(x) x
 #define PROFC(x) PROFILER_CALL(x)
 #else
@@ -31,81 +38,750 @@
 #include <opencv2/dnn.hpp>
 
 #include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 
 #include "cli/ArgumentParser.hpp"
-#include "Serial/SerialPort.hpp"
+#include "Serial/PortDiscovery.hpp"
+#include "Serial/SerialService.hpp"
+#include "Serial/ServoProtocol.hpp"
 
 #include "gl/gl.hpp"
 
 #include "vidIO/Camera.hpp"
+#include "vidIO/CameraGroup.hpp"
+#include "vidIO/FileCameraAdapter.hpp"
+#include "vidIO/FrameRing.hpp"
+
+#include "pipeline/Channel.hpp"
+#include "pipeline/DedicatedThread.hpp"
+#include "pipeline/Mailbox.hpp"
+#include "pipeline/Pipeline.hpp"
+#include "pipeline/StageStats.hpp"
+#include "pipeline/TaskGraph.hpp"
+
+#include "detect/BackendTuner.hpp"
+#include "detect/BlobPreprocessor.hpp"
+#include "detect/DetectionWriter.hpp"
+#include "detect/ModelLoader.hpp"
+#include "detect/MotionGate.hpp"
+#include "detect/RoiPlanner.hpp"
+#include "detect/SsdDecoder.hpp"
+#include "detect/Tracker.hpp"
+
+#include "control/ServoController.hpp"
+
+#include "metrics/LatencyTrace.hpp"
 
 #include "ImGuiWindows.hpp"
 
 using Image = cv::Mat;
 
+// Set from signal handlers, the supervisor stage acts on them.
+static std::atomic_bool stopSignaled = false;
+static std::atomic_bool traceSignaled = false;
+
+static void onStopSignal(int) { stopSignaled.store(true); }
+static void onTraceSignal(int) { traceSignaled.store(true); }
+
+static std::vector<std::string> splitList(const std::string &list, char delimiter) {
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        const size_t end = std::min(list.find(delimiter, begin), list.size());
+        if (end > begin) items.push_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    return items;
+}
+
+static bool isDeviceIndex(const std::string &source) {
+    return !source.empty() && std::all_of(source.cbegin(), source.cend(),
+            [](unsigned char c) { return std::isdigit(c); });
+}
+
+// Creates the window at a default size together with everything bound to its
+// GL context. Must run on the thread which will render into it.
+static GLFWwindow *createViewport() {
+    if (!glfwInit()) throw std::runtime_error("Could not initialize GLFW.");
+
+    GLFWwindow *wnd = gl::createDefaultWindow("Viewport", 1280, 720);
+    if (!wnd) throw std::runtime_error("Could not create window.");
+    glfwMakeContextCurrent(wnd);
+    glfwSwapInterval(1);
+
+    if (glewInit() != GLEW_OK) throw std::runtime_error("Could not initialize GLEW.");
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    ImGui::CreateContext();
+    ImGuiIO &io = ImGui::GetIO();
+    io.DisplaySize = { 1.0f, 1.0f };
+    io.Fonts->AddFontDefault();
+    io.Fonts->Build();
+
+    ImGui::StyleColorsDark();
+    ImGuiStyle &style = ImGui::GetStyle();
+    style.FrameBorderSize = 1.0f;
+
+    ImGui_ImplGlfw_InitForOpenGL(wnd, true);
+    ImGui_ImplOpenGL3_Init("#version 430");
+
+    return wnd;
+}
+
 int main(int argc, char **argv) {
+    const auto appStarted = std::chrono::steady_clock::now();
+    // stdout may carry detections, see --output.
+    spdlog::set_default_logger(spdlog::stderr_color_mt("GuardianBot"));
     spdlog::info("Loaded application");
     PROFC(EASY_PROFILER_ENABLE);
     PROFC(EASY_MAIN_THREAD);
+    trace::setThreadName("main");
 
-    PROFC(EASY_BLOCK("Parsing arguments"));
+    TRACE_BEGIN("Parsing arguments");
     cli::ArgumentParser ap;
     cli::ArgMap am;
+    int detectEvery = 1;
+    bool useRois = false;
+    bool follow = false;
+    bool headless = false;
+    std::string tracePath = "guardianbot-trace.json";
+    detect::RoiPlanner::Params roiParams;
     try {
         ap.arg(cli::ArgType::String, { .fullName = "prototxt", .shortName = "p" });
         ap.arg(cli::ArgType::String, { .fullName = "model", .shortName = "m" });
+        // Comma separated list of streams, each one is a webcam index, a video file
+        // or a directory of images. Webcam 0 is used if not given.
+        ap.arg(cli::ArgType::String, { .fullName = "source", .shortName = "s" });
+        // "realtime" (default) replays at the recorded frame rate, "fast" as fast as decoded
+        ap.arg(cli::ArgType::String, { .fullName = "pacing", .shortName = "r" });
+        ap.arg(cli::ArgType::Flag, { .fullName = "loop", .shortName = "l" });
+        // Measures DNN backends/targets again even if a choice is cached for the model
+        ap.arg(cli::ArgType::Flag, { .fullName = "autotune", .shortName = "a" });
+        ap.arg(cli::ArgType::String, { .fullName = "backend-cache", .shortName = "c" });
+        // Directory for preprocessed model bundles, warm starts read those instead
+        ap.arg(cli::ArgType::String, { .fullName = "model-cache", .shortName = "k" });
+        // Runs the detector on every N-th frame of a stream and tracks boxes in between
+        ap.arg(cli::ArgType::Number, { .fullName = "detect-every", .shortName = "n" });
+        // Also detects on crops around the last known boxes in the same batch
+        ap.arg(cli::ArgType::Flag, { .fullName = "roi", .shortName = "o" });
+        // With --roi, adds one tile of a sweep over the frame to every N-th detection
+        ap.arg(cli::ArgType::Number, { .fullName = "sweep-every", .shortName = "w" });
+        // Turns the servo after the primary face of the first stream from the start
+        ap.arg(cli::ArgType::Flag, { .fullName = "follow", .shortName = "f" });
+        // Records a trace from the start and writes it there as Chrome JSON on exit.
+        // Tracing can also be switched on and dumped from the pipeline window.
+        ap.arg(cli::ArgType::String, { .fullName = "trace", .shortName = "t" });
+        // Runs without window, GL and ImGui, e.g. on a server. Stops on SIGINT/SIGTERM.
+        ap.arg(cli::ArgType::Flag, { .fullName = "headless", .shortName = "d" });
+        // Writes detections as JSON lines to the file, "-" is stdout, the default when headless
+        ap.arg(cli::ArgType::String, { .fullName = "output", .shortName = "j" });
+        // Serial port of the servo controller to connect to at start
+        ap.arg(cli::ArgType::String, { .fullName = "port", .shortName = "u" });
         spdlog::info("Parsing cli arguments");
         am = ap.parse(argc, argv);
         spdlog::info("Done parsing");
+        if (am.contains("detect-every"))
+            detectEvery = std::max(1, am.at("detect-every").get<int>());
+        if (am.contains("sweep-every"))
+            roiParams.sweepEvery = std::max(0, am.at("sweep-every").get<int>());
+        useRois = am.contains("roi");
+        follow = am.contains("follow");
+        headless = am.contains("headless");
+        if (am.contains("trace")) {
+            tracePath = am.at("trace").get<std::string>();
+            trace::enable(true);
+        }
     }
     catch (const cli::BasicException &e) {
         spdlog::critical("{}", e.what());
         std::exit(-1);
     }
-    PROFC(EASY_END_BLOCK);
+    TRACE_END();
+    if (!am.contains("prototxt") || !am.contains("model")) {
+        spdlog::critical("Both --prototxt and --model are required");
+        std::exit(-1);
+    }
+    const std::vector<std::string> sources =
+        splitList(am.contains("source") ? am.at("source").get<std::string>() : "0", ',');
+    if (sources.empty()) {
+        spdlog::critical("No video source given");
+        std::exit(-1);
+    }
+    const std::string pacing = am.contains("pacing") ? am.at("pacing").get<std::string>() : "realtime";
+    if (pacing != "realtime" && pacing != "fast") {
+        spdlog::critical("Unknown pacing '{}', expected 'realtime' or 'fast'", pacing);
+        std::exit(-1);
+    }
+
+    // Startup steps which don't depend on each other run concurrently. The
+    // render thread owns the window and the GL context from the beginning.
+    spdlog::info("Variables initialization...");
+    std::unique_ptr<PortDiscovery> portDiscovery;
+    std::vector<std::unique_ptr<vidIO::CameraAdapter>> adapters(sources.size());
+    vidIO::CameraGroup cameras;
+    detect::LoadedModel loadedModel;
+    std::unique_ptr<pipeline::DedicatedThread> renderThread;
+    if (!headless) {
+        renderThread = std::make_unique<pipeline::DedicatedThread>();
+        renderThread->post([] { trace::setThreadName("render"); });
+    }
+    GLFWwindow *wnd = nullptr;
+    std::unique_ptr<detect::DetectionWriter> detectionWriter;
+
+    pipeline::TaskGraph startup;
     // WARNING!!!
     // I check for available ports here because later usage of this function deadly
     // interrupts RealSense device work and it crashes.
-    // This must be placed before Camera ctor call at all costs!
-    spdlog::info("Quering available COM ports");
-    const std::vector<std::string> availablePorts = SerialPort::queryAvailable();
-
-    spdlog::info("Variables initialization...");
-    PROFC(EASY_BLOCK("Camera constructor call"));
-    vidIO::Camera cam;
-    PROFC(EASY_END_BLOCK);
-    std::queue<vidIO::Frame> frameQueue;
-    std::vector<cv::Rect> faceRects;
-    std::vector<cv::Rect> rectsBackup;
-    const cv::Scalar borderColor = { 0, 0, 255 };
-    const unsigned int borderThickness = 4u;
+    // This must finish before any camera is opened at all costs!
+    // Later rescans on hotplug only read sysfs or the registry, no device is touched.
+    const size_t portsStep = startup.add("query COM ports", [&] {
+        portDiscovery = std::make_unique<PortDiscovery>();
+    });
+    std::vector<size_t> openSteps;
+    for (size_t i = 0; i < sources.size(); i++) {
+        openSteps.push_back(startup.add("open " + sources[i], [&, i] {
+            if (isDeviceIndex(sources[i])) {
+                spdlog::info("Opening camera {}", sources[i]);
+                adapters[i] = std::make_unique<vidIO::CVCameraAdapter>(std::stoi(sources[i]));
+            }
+            else {
+                spdlog::info("Replaying '{}' with {} pacing", sources[i], pacing);
+                adapters[i] = std::make_unique<vidIO::FileCameraAdapter>(sources[i],
+                        pacing == "fast" ? vidIO::Pacing::AsFastAsPossible : vidIO::Pacing::RealTime,
+                        am.contains("loop"));
+            }
+        }, { portsStep }));
+    }
+    // Streams keep the order they were given in.
+    startup.add("allocate frame rings", [&] {
+        for (std::unique_ptr<vidIO::CameraAdapter> &adapter : adapters) cameras.add(std::move(adapter));
+    }, openSteps);
+    startup.add("load model", [&] {
+        loadedModel = detect::loadCaffeModel(
+                am.at("prototxt").get<std::string>(),
+                am.at("model").get<std::string>(),
+                am.contains("model-cache") ? am.at("model-cache").get<std::string>() : "");
+    });
+    if (!headless) {
+        startup.add("create window", [&] {
+            renderThread->post([&] { wnd = createViewport(); }).get();
+        });
+    }
+    if (headless || am.contains("output")) {
+        startup.add("open output", [&] {
+            detectionWriter = std::make_unique<detect::DetectionWriter>(
+                    am.contains("output") ? am.at("output").get<std::string>() : "-");
+        });
+    }
 
-    std::atomic_bool shouldShutdown = false;
+    TRACE_BEGIN("Startup");
+    try {
+        startup.run();
+    }
+    catch (const std::exception &e) {
+        spdlog::critical("Startup failed: {}", e.what());
+        std::exit(-1);
+    }
+    TRACE_END();
+    for (const pipeline::TaskGraph::Timing &step : startup.timings()) {
+        if (step.done)
+            spdlog::info("Startup step '{}' took {:.1f} ms, started at {:.1f} ms", step.name, step.durationMs, step.startMs);
+        else
+            spdlog::info("Startup step '{}' did not finish", step.name);
+    }
+    if (loadedModel.fromCache) spdlog::info("Model read from cached bundle");
+    if (!loadedModel.cacheError.empty()) spdlog::warn("Model bundle not cached: {}", loadedModel.cacheError);
+
+    const size_t streamsCount = cameras.size();
+    std::vector<std::unique_ptr<vidIO::FrameRing::Consumer>> displayConsumers;
+    std::vector<std::unique_ptr<vidIO::FrameRing::Consumer>> detectionConsumers;
+    for (size_t id = 0; id < streamsCount; id++) {
+        displayConsumers.push_back(std::make_unique<vidIO::FrameRing::Consumer>(cameras.ring(id)));
+        detectionConsumers.push_back(std::make_unique<vidIO::FrameRing::Consumer>(cameras.ring(id)));
+    }
+    const float borderColor[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+    const float borderThickness = 4.0f;
+
+    // Hand-off buffers between detection stages. A batch holds the latest frame
+    // of every stream which had one, each entry carries the metadata of the
+    // frame it was made from.
+    struct BatchEntry {
+        vidIO::FrameMeta meta;
+        cv::Size frameSize;
+        // False for frames which only move the tracks, they are not in the blob.
+        bool detect;
+        // Parts of the frame in the blob in blob order, the whole frame comes first.
+        std::vector<cv::Rect> regions;
+    };
+    struct BlobPacket {
+        std::vector<BatchEntry> entries;
+        cv::Mat blob;
+    };
+    struct InferencePacket {
+        std::vector<BatchEntry> entries;
+        cv::Mat output;
+    };
+    struct Detections {
+        // Frame the boxes were found or predicted on.
+        vidIO::FrameMeta meta;
+        std::vector<cv::Rect> rects;
+    };
+    struct OutputRecord {
+        vidIO::FrameMeta meta;
+        bool detected;
+        std::vector<detect::Track> tracks;
+    };
+    // One blob is filled by preprocess, one waits in the channel and one is read by
+    // inference, so preprocessing of the next batch overlaps the forward pass.
+    // Blobs circulate through freeBlobs and keep their storage between batches.
+    const size_t BLOBS_IN_FLIGHT = 3u;
+    pipeline::Channel<cv::Mat> freeBlobs(BLOBS_IN_FLIGHT);
+    for (size_t i = 0; i < BLOBS_IN_FLIGHT; i++) freeBlobs.push(cv::Mat());
+    pipeline::Channel<BlobPacket> blobChannel(1u);
+    pipeline::Channel<InferencePacket> inferenceChannel(1u);
+    std::vector<pipeline::Mailbox<Detections>> detectionsMailboxes(streamsCount);
+    // Postprocess never waits for the output, records which don't fit are dropped.
+    pipeline::Channel<OutputRecord> outputChannel(64u);
+    std::atomic_uint64_t outputDropped = 0;
+    // Raised by postprocess when the tracks of a stream got unreliable, so its next
+    // frame is detected regardless of detectEvery.
+    std::vector<std::atomic_bool> detectionDue(streamsCount);
+    // Frames due for detection on which nothing moved skip the detector.
+    detect::MotionGateSettings motionSettings;
+    std::vector<std::unique_ptr<detect::MotionGate>> motionGates;
+    for (size_t id = 0; id < streamsCount; id++)
+        motionGates.push_back(std::make_unique<detect::MotionGate>(motionSettings));
+
+    // The servo carries the camera of the first stream. Postprocess publishes
+    // where its primary face is, the control stage turns the servo after it.
+    const size_t FOLLOWED_STREAM = 0;
+    pipeline::Mailbox<control::ServoTarget> servoTargetMailbox;
+    std::atomic_bool following = follow;
+    // Last commanded angle, by hand or by the controller.
+    std::atomic<float> servoAngle = 90.0f;
 
     std::atomic_size_t humansWatched = 0;
+    std::atomic_uint64_t framesDetected = 0;
+    std::atomic_uint64_t framesTracked = 0;
+
+    // Age of the frames at every step from the camera to the screen. "frame shown"
+    // is the glass to glass latency, "boxes shown" how stale the boxes on screen are.
+    metrics::LatencyTrace latency({ "capture", "preprocess", "infer", "postprocess", "upload",
+            "frame shown", "boxes shown" });
+
+    SerialService serial(64u, proto::BAUDRATE);
+    if (am.contains("port")) {
+        const std::string wantedPort = am.at("port").get<std::string>();
+        spdlog::info("Connecting to {}", wantedPort);
+        // Connected by its identity if discovered, so it is found again when
+        // it comes back under another name.
+        const std::vector<PortInfo> ports = portDiscovery->ports();
+        const auto found = std::find_if(ports.begin(), ports.end(),
+                [&wantedPort](const PortInfo &port) { return port.path == wantedPort || port.stableName == wantedPort; });
+        if (found != ports.end()) serial.connect(*found);
+        else serial.connect(wantedPort);
+    }
+    // An unplugged controller is connected again as soon as it is back.
+    portDiscovery->onChange([&](const std::vector<PortInfo> &ports) {
+        spdlog::info("Serial ports changed, {} available", ports.size());
+        if (serial.isConnected()) return;
+
+        // Replugged devices often get another /dev/ttyACM* or COM number.
+        const PortInfo wanted = serial.status().wantedDevice;
+        if (wanted.path.empty()) return;
+        for (const PortInfo &port : ports) {
+            if (!sameDevice(port, wanted)) continue;
+            spdlog::info("Reconnecting to {}", describe(port));
+            serial.connect(port);
+            break;
+        }
+    });
+    spdlog::info("Done initializing");
 
-    const unsigned int BUF_SIZE = 256u;
-    char arduinoCommandBuf[BUF_SIZE] = { 0 };
+    pipeline::Pipeline stages;
+    stages.onStop([&] {
+        cameras.close();
+        freeBlobs.close();
+        blobChannel.close();
+        inferenceChannel.close();
+        outputChannel.close();
+    });
 
-    std::unique_ptr<SerialPort> connected = nullptr;
-    spdlog::info("Done initializing");
+    std::atomic_size_t streamsEnded = 0;
+    for (size_t id = 0; id < streamsCount; id++) {
+        const std::string stageName = "capture" + std::to_string(id);
+        stages.addStage(stageName, [&, id, stageName](pipeline::Pipeline &p) {
+            spdlog::info("Capture stage of stream {} up", id);
+            pipeline::StageStats &stats = p.stats(stageName);
+            metrics::LatencyTrace::Recorder &frameTrace = latency.recorder();
+            const uint32_t captureStage = latency.stage("capture");
+            while (!p.stopRequested()) try
+            {
+                TRACE_SCOPE("Reading next frame from camera");
+                // Time in the stage is mostly waiting for the camera to deliver,
+                // the stats count decoding and publishing once the frame is there.
+                std::chrono::steady_clock::time_point delivered;
+                const std::optional<vidIO::FrameMeta> meta = cameras.captureNext(id, &delivered);
+                stats.record(std::chrono::steady_clock::now() - delivered);
+                // The frame enters the stage when the camera hands it over,
+                // decoding and publishing it is the time in the stage.
+                if (meta)
+                    frameTrace.record(captureStage, meta->streamId, meta->sequence, meta->captured, meta->captured);
+            }
+            catch (const vidIO::EndOfStream &e) {
+                spdlog::info("Stream {}: {}", id, e.what());
+                if (++streamsEnded == streamsCount) p.requestStop();
+                break;
+            }
+            catch (const std::runtime_error &e) {
+                spdlog::warn(e.what());
+            }
+            spdlog::info("Capture stage of stream {} shutdown", id);
+        });
+    }
 
-    std::thread renderThread([&] {
-        spdlog::info("Render thread up");
+    stages.addStage("preprocess", [&](pipeline::Pipeline &p) {
+        spdlog::info("Preprocess stage up");
+        detect::BlobPreprocessor preprocessor(cv::Size(300, 300), cv::Scalar(104.0, 177.0, 123.0));
+        spdlog::info("Preprocessing with {} path", preprocessor.path());
+        pipeline::StageStats &stats = p.stats("preprocess");
+        std::vector<vidIO::FrameRing::Lease> leases;
+        std::vector<cv::Mat> images;
+        std::vector<int> framesSinceDetection(streamsCount, detectEvery);
+        std::vector<detect::RoiPlanner> roiPlanners(streamsCount, detect::RoiPlanner(roiParams));
+        // Last known boxes of every stream, crops are placed around them.
+        std::vector<Detections> known(streamsCount);
+        std::vector<uint64_t> knownVersions(streamsCount, 0);
+        metrics::LatencyTrace::Recorder &frameTrace = latency.recorder();
+        const uint32_t preprocessStage = latency.stage("preprocess");
+        const auto traceBatch = [&](const BlobPacket &packet, std::chrono::steady_clock::time_point started) {
+            for (const BatchEntry &entry : packet.entries)
+                frameTrace.record(preprocessStage, entry.meta.streamId, entry.meta.sequence, entry.meta.captured, started);
+        };
+        while (!p.stopRequested()) {
+            // Collects the newest unseen frame of every stream, sleeps if there is none.
+            const uint32_t epoch = cameras.epoch();
+            const auto started = std::chrono::steady_clock::now();
+            BlobPacket packet;
+            leases.clear();
+            images.clear();
+            for (size_t id = 0; id < streamsCount; id++) {
+                vidIO::FrameRing::Lease lease = detectionConsumers[id]->acquireLatest();
+                if (!lease) continue;
+
+                const vidIO::Frame &frame = lease.frame();
+                // Unreliable tracks need the detector even when nothing moves,
+                // the gate still sees the frame to keep its background fresh.
+                const bool forced = detectionDue[id].exchange(false);
+                const bool due = forced || ++framesSinceDetection[id] >= detectEvery;
+                const bool moved = due && motionGates[id]->admit(frame);
+                const bool detect = moved || forced;
+                BatchEntry entry = { lease.meta(), cv::Size(frame.cols, frame.rows), detect };
+                if (detect) {
+                    framesSinceDetection[id] = 0;
+                    entry.regions.emplace_back(0, 0, frame.cols, frame.rows);
+                    if (useRois) {
+                        detectionsMailboxes[id].readIfNewer(known[id], knownVersions[id]);
+                        for (const cv::Rect &roi : roiPlanners[id].plan(entry.frameSize, known[id].rects))
+                            entry.regions.push_back(roi);
+                    }
+                    for (const cv::Rect &region : entry.regions) images.push_back(frame(region));
+                    leases.push_back(std::move(lease));
+                }
+                packet.entries.push_back(std::move(entry));
+            }
+            if (packet.entries.empty()) {
+                cameras.waitForFrames(epoch);
+                continue;
+            }
+            // Tracking only frames pass through inference without a blob.
+            if (images.empty()) {
+                traceBatch(packet, started);
+                if (!blobChannel.push(std::move(packet))) break;
+                continue;
+            }
+
+            std::optional<cv::Mat> blob = freeBlobs.pop();
+            if (!blob) break;
+
+            {
+                TRACE_SCOPE("Preprocessing frames");
+                const pipeline::ScopedStageTimer timer(stats);
+                preprocessor.run(images, *blob);
+                packet.blob = std::move(*blob);
+            }
+            // Give the slots back to capture before possibly waiting for inference.
+            images.clear();
+            leases.clear();
+            traceBatch(packet, started);
+            if (!blobChannel.push(std::move(packet))) break;
+        }
+        spdlog::info("Preprocess stage shutdown");
+    });
+
+    stages.addStage("infer", [&](pipeline::Pipeline &p) {
+        spdlog::info("Infer stage up");
+        cv::dnn::Net nnet = std::move(loadedModel.net);
+        const uint64_t modelHash = loadedModel.hash;
+        // Largest batch the preprocess stage builds: every stream's frame plus its crops.
+        const int maxBatch = static_cast<int>(streamsCount * (1u + (useRois ? detect::RoiPlanner::maxCrops(roiParams) : 0u)));
 
         try {
-            if (!glfwInit()) throw std::runtime_error("Could not initialize GLFW.");
+            TRACE_SCOPE("Selecting DNN backend");
+            const detect::BackendTuner tuner(am.contains("backend-cache")
+                    ? am.at("backend-cache").get<std::string>() : "backend.cache");
+            const std::optional<detect::BackendChoice> cached = tuner.cached(modelHash, maxBatch);
+            if (cached && !am.contains("autotune")) {
+                spdlog::info("Using cached DNN backend {}", detect::describe(*cached));
+                detect::BackendTuner::apply(nnet, *cached);
+            }
+            else {
+                spdlog::info("Benchmarking DNN backends at batch size {}...", maxBatch);
+                const int sizes[] = { maxBatch, 3, 300, 300 };
+                const cv::Mat input(4, sizes, CV_32F, cv::Scalar(0.0));
+                const std::vector<detect::BackendTiming> timings = tuner.benchmark(nnet, input);
+                for (const detect::BackendTiming &timing : timings) {
+                    if (timing.error.empty())
+                        spdlog::info("  {}: {:.2f} ms", detect::describe(timing.choice), timing.averageMs);
+                    else
+                        spdlog::info("  {}: unusable, {}", detect::describe(timing.choice), timing.error);
+                }
+
+                const detect::BackendChoice best = !timings.empty() && timings.front().error.empty()
+                        ? timings.front().choice : detect::BackendChoice();
+                spdlog::info("Selected DNN backend {}", detect::describe(best));
+                detect::BackendTuner::apply(nnet, best);
+                tuner.store(modelHash, maxBatch, best);
+            }
+        }
+        catch (const std::runtime_error &e) {
+            // The default backend still works, only the choice is not remembered.
+            spdlog::warn("DNN backend selection: {}", e.what());
+        }
+
+        pipeline::StageStats &stats = p.stats("infer");
+        metrics::LatencyTrace::Recorder &frameTrace = latency.recorder();
+        const uint32_t inferStage = latency.stage("infer");
+        const auto traceBatch = [&](const InferencePacket &packet, std::chrono::steady_clock::time_point started) {
+            for (const BatchEntry &entry : packet.entries)
+                frameTrace.record(inferStage, entry.meta.streamId, entry.meta.sequence, entry.meta.captured, started);
+        };
+        while (auto packet = blobChannel.pop()) try
+        {
+            const auto started = std::chrono::steady_clock::now();
+            InferencePacket result = { std::move(packet->entries), cv::Mat() };
+            if (packet->blob.empty()) {
+                traceBatch(result, started);
+                if (!inferenceChannel.push(std::move(result))) break;
+                continue;
+            }
+
+            {
+                TRACE_SCOPE("Detection");
+                const pipeline::ScopedStageTimer timer(stats);
+                nnet.setInput(packet->blob);
+                // forward() hands out the DetectionOutput layer's own blob, with or
+                // without an output argument. The next pass overwrites it while
+                // postprocess may still decode it, so the detections are copied.
+                result.output = nnet.forward().clone();
+            }
+            traceBatch(result, started);
+            freeBlobs.push(std::move(packet->blob));
+            if (!inferenceChannel.push(std::move(result))) break;
+        }
+        catch (const std::exception &e) {
+            spdlog::warn("Dropping detection frame, something is wrong.\n{}", e.what());
+            freeBlobs.push(std::move(packet->blob));
+        }
+        spdlog::info("Infer stage shutdown");
+    });
 
-                GLFWwindow *wnd = gl::createDefaultWindow("Viewport",
-                        2 * cam.frameData().width,
-                        2 * cam.frameData().height);
-            glfwMakeContextCurrent(wnd);
-            glfwSwapInterval(1);
+    stages.addStage("postprocess", [&](pipeline::Pipeline &p) {
+        spdlog::info("Postprocess stage up");
+        const float defaultConfidence = 0.8f;
+        // Crops overlap the whole frame and each other, so a face may be found twice.
+        const float maxOverlap = 0.4f;
+        pipeline::StageStats &stats = p.stats("postprocess");
+        std::vector<detect::Tracker> trackers(streamsCount);
+        std::vector<size_t> watchedPerStream(streamsCount, 0);
+        std::vector<cv::Size> frameSizes;
+        int primaryId = -1;
+        metrics::LatencyTrace::Recorder &frameTrace = latency.recorder();
+        const uint32_t postprocessStage = latency.stage("postprocess");
+        while (auto packet = inferenceChannel.pop()) {
+            const pipeline::ScopedStageTimer timer(stats);
+            const auto started = std::chrono::steady_clock::now();
+            frameSizes.clear();
+            for (const BatchEntry &entry : packet->entries)
+                for (const cv::Rect &region : entry.regions) frameSizes.push_back(region.size());
+            const std::vector<detect::Detections> decoded =
+                detect::decodeSsdOutput(packet->output, frameSizes, defaultConfidence);
+
+            size_t imageId = 0;
+            for (const BatchEntry &entry : packet->entries) {
+                detect::Tracker &tracker = trackers[entry.meta.streamId];
+                if (entry.detect) {
+                    // Boxes found in crops are moved back to frame coordinates.
+                    detect::Detections inFrame;
+                    for (const cv::Rect &region : entry.regions) {
+                        for (detect::Detection d : decoded[imageId++]) {
+                            d.box.x += region.x;
+                            d.box.y += region.y;
+                            inFrame.push_back(d);
+                        }
+                    }
+                    tracker.update(entry.regions.size() > 1 ? detect::mergeDetections(inFrame, maxOverlap) : inFrame);
+                    if (framesDetected.fetch_add(1) == 0) {
+                        const std::chrono::duration<double, std::milli> sinceStart =
+                            std::chrono::steady_clock::now() - appStarted;
+                        spdlog::info("First detection {:.0f} ms after start", sinceStart.count());
+                    }
+                }
+                else {
+                    tracker.predict();
+                    framesTracked++;
+                }
+                if (tracker.needsDetection()) detectionDue[entry.meta.streamId] = true;
+
+                Detections found;
+                found.meta = entry.meta;
+                for (const detect::Track &track : tracker.tracks()) found.rects.push_back(track.rect());
+
+                watchedPerStream[entry.meta.streamId] = tracker.tracks().size();
+                if (entry.meta.streamId == FOLLOWED_STREAM) {
+                    control::ServoTarget target;
+                    target.captured = entry.meta.captured;
+                    target.sequence = entry.meta.sequence;
+                    if (const detect::Track *primary = tracker.primary(primaryId)) {
+                        const float centre = primary->box.x + 0.5f * primary->box.width;
+                        const float half = 0.5f * static_cast<float>(entry.frameSize.width);
+                        target.valid = true;
+                        target.offset = (centre - half) / half;
+                        target.trackId = primaryId = primary->id;
+                    }
+                    servoTargetMailbox.post(target);
+                }
+                frameTrace.record(postprocessStage, entry.meta.streamId, entry.meta.sequence, entry.meta.captured, started);
+                detectionsMailboxes[entry.meta.streamId].post(std::move(found));
+                if (detectionWriter && !outputChannel.tryPush({ entry.meta, entry.detect, tracker.tracks() }))
+                    outputDropped++;
+            }
+            humansWatched = std::accumulate(watchedPerStream.cbegin(), watchedPerStream.cend(), size_t(0));
+        }
+        spdlog::info("Postprocess stage shutdown");
+    });
+
+    stages.addStage("control", [&](pipeline::Pipeline &p) {
+        spdlog::info("Control stage up");
+        // Commands go out on a fixed period, independent of the detection rate.
+        const auto CONTROL_PERIOD = std::chrono::milliseconds(20);
+        pipeline::StageStats &stats = p.stats("control");
+        control::ServoController controller(servoAngle.load());
+        control::ServoTarget target;
+        uint64_t targetVersion = 0;
+        // Version of the last measurement whose latency to the servo was taken.
+        uint64_t timedVersion = 0;
+        long sentTenths = -1;
+        bool wasFollowing = false;
+        auto nextTick = control::Clock::now();
+        while (!p.stopRequested()) {
+            std::this_thread::sleep_until(nextTick);
+            nextTick += CONTROL_PERIOD;
+            const auto now = control::Clock::now();
+            if (!following.load() || !serial.isConnected()) {
+                wasFollowing = false;
+                continue;
+            }
+
+            const pipeline::ScopedStageTimer timer(stats);
+            if (!wasFollowing) {
+                // Continue from wherever the servo was turned by hand.
+                controller.reset(servoAngle.load(), now);
+                sentTenths = -1;
+                wasFollowing = true;
+            }
+            servoTargetMailbox.readIfNewer(target, targetVersion);
+            const float angle = controller.update(target, now);
+            servoAngle = angle;
+
+            // The servo holds its position, only changes are sent.
+            const long tenths = std::lround(angle * 10.0f);
+            if (tenths == sentTenths) continue;
+
+            // Only the first command reacting to a measurement is timed from its
+            // capture, later ones would count the control period as latency.
+            const bool firstForTarget = targetVersion != timedVersion;
+            if (serial.sendFrame(proto::setAngle(proto::nextSeq(), 0, angle),
+                    firstForTarget ? target.captured : control::Clock::time_point())) {
+                sentTenths = tenths;
+                timedVersion = targetVersion;
+            }
+        }
+        spdlog::info("Control stage shutdown");
+    });
+
+    if (detectionWriter) stages.addStage("output", [&](pipeline::Pipeline &p) {
+        spdlog::info("Output stage up");
+        pipeline::StageStats &stats = p.stats("output");
+        while (auto record = outputChannel.pop()) try
+        {
+            const pipeline::ScopedStageTimer timer(stats);
+            detectionWriter->write(record->meta.streamId, record->meta.sequence, record->meta.captured,
+                    record->detected, record->tracks);
+        }
+        catch (const std::runtime_error &e) {
+            // Nobody reads the detections anymore, e.g. the pipe was closed.
+            spdlog::error(e.what());
+            p.requestStop();
+            break;
+        }
+        spdlog::info("Output stage shutdown");
+    });
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+#ifndef _WIN32
+    // A closed reader of --output makes the write fail with EPIPE, the output
+    // stage then stops the pipeline instead of the signal killing the process.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, onTraceSignal);
+#endif
+    stages.addStage("supervisor", [&](pipeline::Pipeline &p) {
+        // Signals are only flagged by their handlers, the reaction happens here.
+        while (!p.stopRequested()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (stopSignaled.exchange(false)) {
+                spdlog::info("Stop signal received, shutting down");
+                p.requestStop();
+            }
+            if (traceSignaled.exchange(false)) {
+                try {
+                    const size_t events = trace::writeChromeJson(tracePath);
+                    spdlog::info("Wrote {} trace events to {}", events, tracePath);
+                }
+                catch (const std::runtime_error &e) {
+                    spdlog::error(e.what());
+                }
+            }
+            // The display refreshes the latency summary itself, without it
+            // the recorders are drained here.
+            if (headless) latency.collect();
+        }
+    });
 
-            if (glewInit() != GLEW_OK) throw std::runtime_error("Could not initialize GLEW.");
+    if (!headless) stages.addStage("display", [&](pipeline::Pipeline &p) {
+        spdlog::info("Display stage up");
 
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glEnable(GL_BLEND);
+        // Every GL call has to come from the thread which created the context.
+        renderThread->post([&] {
+            // The window was created before the frame size was known.
+            const vidIO::FrameData &firstFrame = cameras.camera(0).frameData();
+            gl::fitWindow(wnd, 2 * firstFrame.width, 2 * firstFrame.height);
 
             const GLuint VERTICES_COUNT = 4;
             const float verticesData[16] =
@@ -131,59 +807,97 @@ int main(int argc, char **argv) {
                 0, 2, 3
             };
             gl::IndexBuffer ib(indices, ELEMENTS_COUNT, GL_STATIC_DRAW);
-            gl::Texture tex(GL_TEXTURE_2D);
-            tex.setAttr(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            tex.setAttr(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            tex.setAttr(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            tex.setAttr(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            // Streams may differ in resolution, the texture is recreated on switch.
+            std::unique_ptr<gl::StreamingTexture> tex;
+            size_t texStream = streamsCount;
 
             const gl::Program prog = gl::loadDefaultShaders();
             prog.use();
-
-            ImGui::CreateContext();
-            ImGuiIO &io = ImGui::GetIO();
-            io.DisplaySize = { 1.0f, 1.0f };
-            io.Fonts->AddFontDefault();
-            io.Fonts->Build();
-
-            ImGui::StyleColorsDark();
-            ImGuiStyle &style = ImGui::GetStyle();
-            style.FrameBorderSize = 1.0f;
-
-            ImGui_ImplGlfw_InitForOpenGL(wnd, true);
-            ImGui_ImplOpenGL3_Init("#version 430");
-
-            while (!glfwWindowShouldClose(wnd))
+            // Frames are uploaded untouched: top row first and in BGR order.
+            prog.setUniform("u_flipY", 1);
+            prog.setUniform("u_swapRB", 1);
+
+            gl::OverlayRenderer overlay;
+            overlay.setColor(borderColor[0], borderColor[1], borderColor[2], borderColor[3]);
+            overlay.setThickness(borderThickness);
+
+            Detections shown;
+            uint64_t shownVersion = 0;
+            int selectedStream = 0;
+            std::vector<PortInfo> ports;
+            uint64_t portsVersion = 0;
+            pipeline::StageStats &stats = p.stats("display");
+            metrics::LatencyTrace::Recorder &frameTrace = latency.recorder();
+            const uint32_t uploadStage = latency.stage("upload");
+            const uint32_t frameShownStage = latency.stage("frame shown");
+            const uint32_t boxesShownStage = latency.stage("boxes shown");
+            // Frame and boxes which are new in this swap, sequence 0 if there are none.
+            vidIO::FrameMeta uploaded, boxes;
+            std::chrono::steady_clock::time_point uploadedAt, boxesAt;
+            // Summarizing is not free, the window is refreshed a few times a second.
+            std::vector<metrics::LatencyTrace::StageLatency> latencySummary;
+            std::chrono::steady_clock::time_point summarizedAt;
+
+            while (!glfwWindowShouldClose(wnd) && !p.stopRequested())
             {
+                std::optional<pipeline::ScopedStageTimer> timer(std::in_place, stats);
                 glClear(GL_COLOR_BUFFER_BIT);
 
-                PROFC(EASY_BLOCK("Loading image into texture memory"));
-                if (!frameQueue.empty()) {
-                    const vidIO::Frame &f = frameQueue.front();
-                    if (!faceRects.empty()) {
-                        for (const cv::Rect &r : faceRects)
-                            cv::rectangle(f, r, borderColor, borderThickness);
-                        rectsBackup = faceRects;
-                    }
-                    else {
-                        for (const cv::Rect &r : rectsBackup)
-                            cv::rectangle(f, r, borderColor, borderThickness);
-                    }
-                    gl::loadCVmat2GLTexture(tex, f, true);
-                    if (frameQueue.size() > 1)
-                        frameQueue.pop();
+                const size_t streamId = static_cast<size_t>(selectedStream);
+                if (texStream != streamId) {
+                    const vidIO::FrameData &fdat = cameras.camera(streamId).frameData();
+                    tex = std::make_unique<gl::StreamingTexture>(static_cast<GLsizei>(fdat.width),
+                            static_cast<GLsizei>(fdat.height));
+                    tex->setAttr(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                    tex->setAttr(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                    tex->setAttr(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                    tex->setAttr(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                    texStream = streamId;
+                    shownVersion = 0;
+                    shown = Detections();
+                    overlay.setRects(shown.rects);
+                }
+
+                TRACE_BEGIN("Loading image into texture memory");
+                const auto uploadStarted = std::chrono::steady_clock::now();
+                if (const vidIO::FrameRing::Lease lease = displayConsumers[streamId]->acquireLatest()) {
+                    tex->upload(lease.frame());
+                    uploaded = lease.meta();
+                    uploadedAt = std::chrono::steady_clock::now();
+                    frameTrace.record(uploadStage, uploaded.streamId, uploaded.sequence, uploaded.captured,
+                            uploadStarted, uploadedAt);
+                }
+                TRACE_END();
+                if (detectionsMailboxes[streamId].readIfNewer(shown, shownVersion)) {
+                    overlay.setRects(shown.rects);
+                    boxes = shown.meta;
+                    boxesAt = std::chrono::steady_clock::now();
                 }
-                PROFC(EASY_END_BLOCK);
-                tex.bind();
 
+                prog.use();
+                va.bind();
+                tex->bind();
                 glDrawElements(GL_TRIANGLES, ELEMENTS_COUNT, GL_UNSIGNED_INT, nullptr);
-                tex.unbind();
+                tex->unbind();
+
+                overlay.draw(tex->getWidth(), tex->getHeight());
 
                 ImGui_ImplOpenGL3_NewFrame();
                 ImGui_ImplGlfw_NewFrame();
                 ImGui::NewFrame();
-                wnd::showWatcherWindow(humansWatched.load());
-                wnd::showControllerWindow(connected, arduinoCommandBuf, BUF_SIZE, availablePorts);
+                if (portDiscovery->version() != portsVersion) {
+                    portsVersion = portDiscovery->version();
+                    ports = portDiscovery->ports();
+                }
+                wnd::showWatcherWindow(humansWatched.load(), selectedStream, streamsCount);
+                wnd::showControllerWindow(serial, ports, following, servoAngle);
+                wnd::showPipelineWindow(p.allStats(), tracePath);
+                wnd::showMotionGateWindow(motionSettings, motionGates);
+                if (std::chrono::steady_clock::now() - summarizedAt >= std::chrono::milliseconds(500)) {
+                    latencySummary = latency.summary();
+                    summarizedAt = std::chrono::steady_clock::now();
+                }
+                wnd::showLatencyWindow(latencySummary);
                 ImGui::EndFrame();
 
                 int displayW, displayH;
@@ -192,7 +906,18 @@ int main(int argc, char **argv) {
                 ImGui::Render();
                 ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+                // Waiting for vsync is not the stage's work
+                timer.reset();
                 glfwSwapBuffers(wnd);
+                // The swap returns once the frame is queued for the screen, the
+                // compositor and the monitor still add their own delay.
+                const auto swapped = std::chrono::steady_clock::now();
+                if (uploaded.sequence != 0)
+                    frameTrace.record(frameShownStage, uploaded.streamId, uploaded.sequence, uploaded.captured,
+                            uploadedAt, swapped);
+                if (boxes.sequence != 0)
+                    frameTrace.record(boxesShownStage, boxes.streamId, boxes.sequence, boxes.captured, boxesAt, swapped);
+                uploaded = boxes = vidIO::FrameMeta();
                 glfwPollEvents();
             }
 
@@ -203,119 +928,76 @@ int main(int argc, char **argv) {
 
             glfwDestroyWindow(wnd);
             glfwTerminate();
-        }
-        catch (const std::runtime_error &e) {
-            // Catching glew and glfw initialization errors
-            spdlog::critical(e.what());
-            std::exit(-1);
-        }
+        }).get();
 
-        shouldShutdown = true;
+        p.requestStop();
 
-        spdlog::info("Render thread shutdown");
+        spdlog::info("Display stage shutdown");
     });
-    renderThread.detach();
 
-    std::thread netThread([&] {
-        spdlog::info("Net thread up");
-        try {
-            spdlog::info("Reading model from file...");
-            PROFC(EASY_BLOCK("Reading model from file"));
-            cv::dnn::Net nnet = cv::dnn::readNetFromCaffe(
-                    am.at("prototxt").get<std::string>(),
-                    am.at("model").get<std::string>());
-            PROFC(EASY_END_BLOCK);
-
-            const float defaultConfidence = 0.8f;
-            const cv::Scalar mean = cv::Scalar(104.0, 177.0, 123.0);
-            while (!shouldShutdown)
-            {
-                if (!frameQueue.empty()) {
-                    PROFC(EASY_BLOCK("Copying next frame from queue"));
-                    const vidIO::Frame frameCopy = frameQueue.front();
-                    PROFC(EASY_END_BLOCK);
-
-                    try {
-                        PROFC(EASY_BLOCK("Detection", profiler::colors::Blue));
-                        const cv::Mat blob = cv::dnn::blobFromImage(frameCopy, 1.0f, cv::Size(300, 300), mean, false, false);
-                        nnet.setInput(blob);
-                        const cv::Mat detection = nnet.forward();
-                        PROFC(EASY_END_BLOCK);
-
-                        // As far as I understood, cv::Mat::size represents:
-                        // size[0] - mat rows
-                        // size[1] - mat columns
-                        // size[2] - mat depth
-                        // size[3] - something like data per detection (especially for detections
-                        // produced by cv::Net)
-                        
-                        const cv::Mat detections = cv::Mat(detection.size[2], detection.size[3],
-                                CV_32F,
-                                (void *)detection.ptr<float>());
-                        if (!faceRects.empty())
-                            faceRects.clear();
-
-                        for (int i = 0; i < detections.rows; i++) {
-                            const float confidence = detections.at<float>(i, 2);
-
-                            if (confidence >= defaultConfidence) {
-                                const int xLeftBottom = static_cast<int>(detections.at<float>(i, 3) * frameCopy.cols);
-                                const int yLeftBottom = static_cast<int>(detections.at<float>(i, 4) * frameCopy.rows);
-                                const int xRightTop = static_cast<int>(detections.at<float>(i, 5) * frameCopy.cols);
-                                const int yRightTop = static_cast<int>(detections.at<float>(i, 6) * frameCopy.rows);
-
-                                faceRects.emplace_back
-                                (
-                                    xLeftBottom,
-                                    yLeftBottom,
-                                    xRightTop - xLeftBottom,
-                                    yRightTop - yLeftBottom
-                                );
-                            }
-                        }
-                        humansWatched = faceRects.size();
-                    }
-                    catch (const std::exception &e) {
-                        spdlog::warn("Dropping detection frame, something is wrong.\n{}",
-                                e.what());
-                        continue;
-                    }
-                }
-            }
-        }
-        catch (const std::out_of_range &e) {
-            spdlog::critical("Referencing command line argument with no value:\n{}", e.what());
-            std::exit(-1);
-        }
-        spdlog::info("Network thread shutdown");
-    });
-    netThread.detach();
-
-    spdlog::info("Main thread up");
-    while (!shouldShutdown) try
-    {
-        PROFC(EASY_BLOCK("Reading next frame from camera"));
-        const vidIO::Frame frame = cam.nextFrame();
-        frameQueue.push(frame);
-        PROFC(EASY_END_BLOCK);
+    if (headless) spdlog::info("Running headless, Ctrl+C or SIGTERM stops");
+    const auto pipelineStarted = std::chrono::steady_clock::now();
+    stages.start();
+    try {
+        stages.join();
     }
-    catch (const std::runtime_error &e) {
-        spdlog::warn(e.what());
+    catch (const std::exception &e) {
+        spdlog::critical("Stage '{}' failed: {}", stages.failedStage(), e.what());
     }
-    spdlog::info("Main thread shutdown");
-    spdlog::info("Trying to close serial port if opened...");
-    if (connected) {
+    const std::chrono::duration<double> pipelineUptime = std::chrono::steady_clock::now() - pipelineStarted;
+    spdlog::info("Detected on {} frames in {:.1f} s ({:.1f} FPS)", framesDetected.load(), pipelineUptime.count(),
+            framesDetected.load() / pipelineUptime.count());
+    if (detectEvery > 1)
+        spdlog::info("Tracked without detection on {} frames (detecting every {})", framesTracked.load(), detectEvery);
+    for (size_t id = 0; id < streamsCount; id++)
+        spdlog::info("Stream {}: motion gate let {} of {} frames through", id,
+                motionGates[id]->admitted(), motionGates[id]->checked());
+    for (const auto &[name, stageStats] : stages.allStats()) {
+        spdlog::info("Stage {}: {} items, {:.2f} ms average, {:.0f}% busy", name,
+                stageStats->processed(), stageStats->averageMs(), 100.0 * stageStats->utilization());
+    }
+    for (size_t id = 0; id < streamsCount; id++) {
+        spdlog::info("Stream {} frames dropped: capture {}, detection {}, display {}", id,
+                cameras.ring(id).dropped(), detectionConsumers[id]->dropped(), displayConsumers[id]->dropped());
+    }
+    if (detectionWriter)
+        spdlog::info("Detections written for {} frames, {} dropped", detectionWriter->written(), outputDropped.load());
+    for (const metrics::LatencyTrace::StageLatency &stage : latency.summary()) {
+        if (stage.sinceCapture.count == 0) continue;
+        spdlog::info("Latency after {}: p50 {:.1f} ms, p95 {:.1f} ms, p99 {:.1f} ms since capture, "
+                "{:.2f} ms p50 in stage", stage.name, stage.sinceCapture.p50Ms, stage.sinceCapture.p95Ms,
+                stage.sinceCapture.p99Ms, stage.inStage.p50Ms);
+    }
+    if (latency.dropped() > 0)
+        spdlog::warn("Latency events dropped: {}", latency.dropped());
+    // Its watcher may reconnect the serial port, it has to go first.
+    portDiscovery.reset();
+    spdlog::info("Sending queued serial commands and closing the port...");
+    serial.stop();
+    const SerialServiceStatus serialStatus = serial.status();
+    spdlog::info("Serial commands: {} sent, {} coalesced, {} rejected, {} failed", serialStatus.sent,
+            serialStatus.coalesced, serialStatus.rejected, serialStatus.failed);
+    if (serialStatus.roundTrip.count > 0)
+        spdlog::info("Serial round trip: p50 {:.1f} ms, p95 {:.1f} ms, p99 {:.1f} ms, max {:.1f} ms over {} acks, "
+                "{} refused, {} never acked", serialStatus.roundTrip.p50Ms, serialStatus.roundTrip.p95Ms,
+                serialStatus.roundTrip.p99Ms, serialStatus.roundTrip.maxMs, serialStatus.roundTrip.count,
+                serialStatus.refused, serialStatus.unacked);
+    if (serialStatus.maxLatencyMs > 0.0)
+        spdlog::info("Frame capture to servo command written: {:.1f} ms recent, {:.1f} ms max",
+                serialStatus.recentLatencyMs, serialStatus.maxLatencyMs);
+    if (!serialStatus.lastError.empty())
+        spdlog::warn("Last serial error: {}", serialStatus.lastError);
+
+    if (trace::isEnabled()) {
         try {
-            spdlog::info("Serial port opened, closing...");
-            connected->close();
-            spdlog::info("Closed serial port connection");
+            const size_t events = trace::writeChromeJson(tracePath);
+            spdlog::info("Wrote {} trace events to {}", events, tracePath);
         }
         catch (const std::runtime_error &e) {
-            spdlog::warn(e.what());
+            spdlog::error(e.what());
         }
     }
-
-    PROFC(profiler::dumpBlocksToFile("C:/dev/GuardianBot/dumps/test.prof"));
+    PROFC(profiler::dumpBlocksToFile(std::filesystem::path(tracePath).replace_extension(".prof").string().c_str()));
 
     return 0;
 }
\ No newline at end of file
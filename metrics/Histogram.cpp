@@ -0,0 +1,92 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace metrics {
+    void Histogram::record(std::chrono::steady_clock::duration value) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(value).count();
+        this->recordUs(us > 0 ? static_cast<uint64_t>(us) : 0u);
+    }
+
+    void Histogram::recordUs(uint64_t us) {
+        buckets_[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(us, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (us > max && !max_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+    }
+
+    void Histogram::add(const Histogram &other) {
+        for (size_t i = 0; i < BUCKETS; i++)
+            buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+
+        const uint64_t otherMax = other.maxUs();
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (otherMax > max && !max_.compare_exchange_weak(max, otherMax, std::memory_order_relaxed)) {}
+    }
+
+    void Histogram::reset() {
+        for (std::atomic_uint64_t &bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    double Histogram::meanUs() const {
+        const uint64_t count = this->count();
+
+        return count ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / count : 0.0;
+    }
+
+    double Histogram::percentileUs(double p) const {
+        // The total is taken from the buckets, count_ may be ahead of them.
+        uint64_t total = 0;
+        for (const std::atomic_uint64_t &bucket : buckets_) total += bucket.load(std::memory_order_relaxed);
+        if (total == 0) return 0.0;
+
+        const auto rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(midpointOf(i), static_cast<double>(this->maxUs()));
+        }
+
+        return static_cast<double>(this->maxUs());
+    }
+
+    size_t Histogram::bucketOf(uint64_t us) {
+        if (us < LINEAR_BUCKETS) return static_cast<size_t>(us);
+
+        // 16 <= us, so the highest bit is at least 4.
+        const unsigned highest = 63u - static_cast<unsigned>(std::countl_zero(us));
+        const auto sub = static_cast<size_t>((us >> (highest - 3u)) & (SUB_BUCKETS - 1u));
+
+        return LINEAR_BUCKETS + (highest - 4u) * SUB_BUCKETS + sub;
+    }
+
+    double Histogram::midpointOf(size_t bucket) {
+        if (bucket < LINEAR_BUCKETS) return static_cast<double>(bucket);
+
+        const size_t highest = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + 4u;
+        const size_t sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+        const double width = static_cast<double>(uint64_t(1) << (highest - 3u));
+        const double lower = static_cast<double>(uint64_t(1) << highest) + sub * width;
+
+        return lower + 0.5 * width;
+    }
+
+    Percentiles summarize(const Histogram &histogram) {
+        Percentiles summary;
+        summary.count = histogram.count();
+        summary.p50Ms = histogram.percentileUs(0.50) / 1000.0;
+        summary.p95Ms = histogram.percentileUs(0.95) / 1000.0;
+        summary.p99Ms = histogram.percentileUs(0.99) / 1000.0;
+        summary.maxMs = static_cast<double>(histogram.maxUs()) / 1000.0;
+
+        return summary;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace metrics {
+    // Lock-free histogram of durations in microseconds. Values below 16 us get
+    // a bucket each, above that every power of two is split into 8 buckets, so
+    // percentiles are within 1/16 of the true value from a few kilobytes of
+    // counters. Any thread may record and read at the same time.
+    class Histogram {
+    public:
+        static const size_t LINEAR_BUCKETS = 16u;
+        static const size_t SUB_BUCKETS = 8u;
+        static const size_t BUCKETS = LINEAR_BUCKETS + (64u - 4u) * SUB_BUCKETS;
+
+        Histogram() = default;
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+        void record(std::chrono::steady_clock::duration value);
+        void recordUs(uint64_t us);
+        // Adds the records of other, e.g. to look at several windows at once.
+        void add(const Histogram &other);
+        void reset();
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t maxUs() const { return max_.load(std::memory_order_relaxed); }
+        double meanUs() const;
+        // Value below which the given share of the records lies, p in 0..1.
+        // Counts recorded meanwhile may or may not be taken into account.
+        double percentileUs(double p) const;
+
+    private:
+        static size_t bucketOf(uint64_t us);
+        // Middle of the values falling into the bucket.
+        static double midpointOf(size_t bucket);
+
+        std::array<std::atomic_uint64_t, BUCKETS> buckets_{};
+        std::atomic_uint64_t count_ = 0;
+        std::atomic_uint64_t sum_ = 0;
+        std::atomic_uint64_t max_ = 0;
+    };
+
+    struct Percentiles {
+        uint64_t count = 0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    Percentiles summarize(const Histogram &histogram);
+}
@@ -0,0 +1,98 @@
+#include "LatencyTrace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace metrics {
+    void LatencyTrace::Recorder::record(uint32_t stage, size_t streamId, uint64_t sequence,
+            Clock::time_point captured, Clock::time_point started, Clock::time_point finished) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == CAPACITY) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Event &event = events_[tail & (CAPACITY - 1u)];
+        event.stage = stage;
+        event.streamId = static_cast<uint32_t>(streamId);
+        event.sequence = sequence;
+        event.captured = captured;
+        event.started = started;
+        event.finished = finished;
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    LatencyTrace::LatencyTrace(std::vector<std::string> stages, Clock::duration window)
+        : names_(std::move(stages)), window_(window),
+          stages_(std::make_unique<StageHistograms[]>(names_.size())), windowStarted_(Clock::now()) {}
+
+    uint32_t LatencyTrace::stage(const std::string &name) const {
+        const auto found = std::find(names_.cbegin(), names_.cend(), name);
+        if (found == names_.cend()) throw std::invalid_argument("Unknown latency stage '" + name + "'.");
+
+        return static_cast<uint32_t>(found - names_.cbegin());
+    }
+
+    LatencyTrace::Recorder &LatencyTrace::recorder() {
+        std::lock_guard lock(mutex_);
+
+        return *recorders_.emplace_back(std::make_unique<Recorder>());
+    }
+
+    void LatencyTrace::collect() {
+        std::lock_guard lock(mutex_);
+
+        const Clock::time_point now = Clock::now();
+        if (now - windowStarted_ >= window_) {
+            // The oldest window makes room for the new one.
+            current_ ^= 1u;
+            for (size_t i = 0; i < names_.size(); i++) {
+                stages_[i].sinceCapture[current_].reset();
+                stages_[i].inStage[current_].reset();
+            }
+            windowStarted_ = now;
+        }
+
+        for (const std::unique_ptr<Recorder> &recorder : recorders_) {
+            const size_t tail = recorder->tail_.load(std::memory_order_acquire);
+            size_t head = recorder->head_.load(std::memory_order_relaxed);
+            for (; head != tail; head++) {
+                const Event &event = recorder->events_[head & (Recorder::CAPACITY - 1u)];
+                if (event.stage >= names_.size()) continue;
+
+                StageHistograms &histograms = stages_[event.stage];
+                histograms.sinceCapture[current_].record(event.finished - event.captured);
+                histograms.inStage[current_].record(event.finished - event.started);
+            }
+            recorder->head_.store(head, std::memory_order_release);
+        }
+    }
+
+    std::vector<LatencyTrace::StageLatency> LatencyTrace::summary() {
+        this->collect();
+
+        std::lock_guard lock(mutex_);
+        std::vector<StageLatency> summary;
+        summary.reserve(names_.size());
+        for (size_t i = 0; i < names_.size(); i++) {
+            Histogram sinceCapture;
+            Histogram inStage;
+            for (size_t window = 0; window < 2; window++) {
+                sinceCapture.add(stages_[i].sinceCapture[window]);
+                inStage.add(stages_[i].inStage[window]);
+            }
+            summary.push_back({ names_[i], summarize(sinceCapture), summarize(inStage) });
+        }
+
+        return summary;
+    }
+
+    uint64_t LatencyTrace::dropped() const {
+        std::lock_guard lock(mutex_);
+        uint64_t dropped = 0;
+        for (const std::unique_ptr<Recorder> &recorder : recorders_)
+            dropped += recorder->dropped_.load(std::memory_order_relaxed);
+
+        return dropped;
+    }
+}
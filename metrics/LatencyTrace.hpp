@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Histogram.hpp"
+
+namespace metrics {
+    // Latency of frames on their way through the pipeline. Every thread which
+    // handles frames gets its own Recorder and only writes into it, recording
+    // is a few plain stores without locks or shared counters. collect() drains
+    // all recorders into one pair of histograms per stage: how old the frame
+    // was when the stage was done with it, and how long the stage held it.
+    // Histograms cover the last one to two windows, so they follow changes.
+    class LatencyTrace {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Event {
+            uint32_t stage = 0;
+            uint32_t streamId = 0;
+            uint64_t sequence = 0;
+            Clock::time_point captured;
+            Clock::time_point started;
+            Clock::time_point finished;
+        };
+
+        // Single producer ring of events, owned by the trace.
+        class Recorder {
+        public:
+            Recorder() = default;
+            Recorder(const Recorder &) = delete;
+            Recorder &operator=(const Recorder &) = delete;
+
+            // The frame captured at captured entered the stage at started and
+            // left it at finished. Dropped when the collector fell behind.
+            void record(uint32_t stage, size_t streamId, uint64_t sequence, Clock::time_point captured,
+                    Clock::time_point started, Clock::time_point finished = Clock::now());
+
+        private:
+            friend class LatencyTrace;
+            static const size_t CAPACITY = 4096u;
+
+            std::array<Event, CAPACITY> events_;
+            // Free running, masked when indexing. Separate lines, each side writes one.
+            alignas(64) std::atomic_size_t head_ = 0;
+            alignas(64) std::atomic_size_t tail_ = 0;
+            std::atomic_uint64_t dropped_ = 0;
+        };
+
+        struct StageLatency {
+            std::string name;
+            // From capture until the stage was done with the frame.
+            Percentiles sinceCapture;
+            // From the frame entering the stage until it left.
+            Percentiles inStage;
+        };
+
+        explicit LatencyTrace(std::vector<std::string> stages, Clock::duration window = std::chrono::seconds(5));
+        LatencyTrace(const LatencyTrace &) = delete;
+        LatencyTrace &operator=(const LatencyTrace &) = delete;
+
+        // Index of a stage passed to the constructor, throws if unknown.
+        uint32_t stage(const std::string &name) const;
+        // Creates the recorder of the calling thread, it lives as long as the trace.
+        Recorder &recorder();
+
+        // Moves everything recorded so far into the histograms.
+        void collect();
+        // Collects and summarizes every stage, in constructor order.
+        std::vector<StageLatency> summary();
+        // Events lost because some recorder was full.
+        uint64_t dropped() const;
+
+    private:
+        struct StageHistograms {
+            // Current and previous window, indexed by window parity.
+            std::array<Histogram, 2> sinceCapture;
+            std::array<Histogram, 2> inStage;
+        };
+
+        const std::vector<std::string> names_;
+        const Clock::duration window_;
+
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<Recorder>> recorders_;
+        // Guarded by mutex_.
+        std::unique_ptr<StageHistograms[]> stages_;
+        size_t current_ = 0;
+        Clock::time_point windowStarted_;
+    };
+}
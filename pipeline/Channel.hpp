@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace pipeline {
+    // Bounded blocking hand-off between two stages. Producers wait while the
+    // channel is full and consumers sleep until an item arrives, close() wakes
+    // everybody up so stages can leave their loops on shutdown.
+    template <typename T>
+    class Channel {
+    public:
+        explicit Channel(size_t capacity = 1u) : capacity_(capacity) {}
+        Channel(const Channel &) = delete;
+        Channel &operator=(const Channel &) = delete;
+
+        bool push(T value) {
+            std::unique_lock lock(mutex_);
+            notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+            if (closed_) return false;
+
+            items_.push_back(std::move(value));
+            lock.unlock();
+            notEmpty_.notify_one();
+
+            return true;
+        }
+
+        // Like push() but gives up instead of waiting when the channel is full.
+        bool tryPush(T value) {
+            std::unique_lock lock(mutex_);
+            if (closed_ || items_.size() >= capacity_) return false;
+
+            items_.push_back(std::move(value));
+            lock.unlock();
+            notEmpty_.notify_one();
+
+            return true;
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock lock(mutex_);
+            notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+            if (items_.empty()) return std::nullopt;
+
+            T value = std::move(items_.front());
+            items_.pop_front();
+            lock.unlock();
+            notFull_.notify_one();
+
+            return value;
+        }
+
+        void close() {
+            {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+            }
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+        bool isClosed() const {
+            std::lock_guard lock(mutex_);
+            return closed_;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+        std::deque<T> items_;
+        const size_t capacity_;
+        bool closed_ = false;
+    };
+}
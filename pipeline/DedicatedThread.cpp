@@ -0,0 +1,41 @@
+#include "DedicatedThread.hpp"
+
+namespace pipeline {
+    DedicatedThread::DedicatedThread() : thread_([this] { this->loop(); }) {}
+
+    DedicatedThread::~DedicatedThread() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        jobsCv_.notify_one();
+        thread_.join();
+    }
+
+    std::future<void> DedicatedThread::post(std::function<void()> job) {
+        std::packaged_task<void()> task(std::move(job));
+        std::future<void> done = task.get_future();
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(task));
+        }
+        jobsCv_.notify_one();
+
+        return done;
+    }
+
+    void DedicatedThread::loop() {
+        for (;;) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                jobsCv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) return;
+
+                task = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            task();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace pipeline {
+    // Thread which runs posted jobs one after another. Meant for APIs bound to
+    // the thread which initialized them, like an OpenGL context or a window's
+    // message queue, when the work is split over several steps.
+    class DedicatedThread {
+    public:
+        DedicatedThread();
+        DedicatedThread(const DedicatedThread &) = delete;
+        DedicatedThread &operator=(const DedicatedThread &) = delete;
+        // Finishes the jobs already posted.
+        ~DedicatedThread();
+
+        // The future rethrows whatever the job has thrown.
+        std::future<void> post(std::function<void()> job);
+
+    private:
+        void loop();
+
+        std::mutex mutex_;
+        std::condition_variable jobsCv_;
+        std::deque<std::packaged_task<void()>> jobs_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+namespace pipeline {
+    // Holds the most recent value published by a stage for readers which must
+    // never wait, e.g. the render loop. Every post bumps the version so readers
+    // can tell whether anything changed since the last look.
+    template <typename T>
+    class Mailbox {
+    public:
+        void post(T value) {
+            std::lock_guard lock(mutex_);
+            value_ = std::move(value);
+            version_++;
+        }
+
+        bool readIfNewer(T &dst, uint64_t &seenVersion) const {
+            std::lock_guard lock(mutex_);
+            if (version_ == seenVersion) return false;
+
+            dst = value_;
+            seenVersion = version_;
+
+            return true;
+        }
+
+        T read() const {
+            std::lock_guard lock(mutex_);
+            return value_;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        T value_{};
+        uint64_t version_ = 0;
+    };
+}
@@ -0,0 +1,77 @@
+#include "Pipeline.hpp"
+
+#include <stdexcept>
+
+#include "trace/Trace.hpp"
+
+namespace pipeline {
+    Pipeline::~Pipeline() {
+        this->requestStop();
+        for (std::thread &t : threads_)
+            if (t.joinable()) t.join();
+    }
+
+    void Pipeline::addStage(const std::string &name, StageBody body) {
+        stages_.push_back({ name, std::move(body), std::make_unique<StageStats>() });
+    }
+
+    StageStats &Pipeline::stats(const std::string &name) {
+        for (Stage &stage : stages_)
+            if (stage.name == name) return *stage.stats;
+
+        throw std::out_of_range("No pipeline stage named '" + name + "'.");
+    }
+
+    std::vector<std::pair<std::string, const StageStats *>> Pipeline::allStats() const {
+        std::vector<std::pair<std::string, const StageStats *>> all;
+        for (const Stage &stage : stages_)
+            all.emplace_back(stage.name, stage.stats.get());
+
+        return all;
+    }
+
+    void Pipeline::onStop(std::function<void()> hook) {
+        std::lock_guard lock(stopMutex_);
+        stopHooks_.push_back(std::move(hook));
+    }
+
+    void Pipeline::start() {
+        for (Stage &stage : stages_) {
+            stage.stats->start();
+            threads_.emplace_back([this, &stage] {
+                trace::setThreadName(stage.name);
+                try {
+                    stage.body(*this);
+                }
+                catch (...) {
+                    {
+                        std::lock_guard lock(stopMutex_);
+                        if (!failure_) {
+                            failure_ = std::current_exception();
+                            failedStage_ = stage.name;
+                        }
+                    }
+                    this->requestStop();
+                }
+            });
+        }
+    }
+
+    void Pipeline::requestStop() {
+        if (stopRequested_.exchange(true, std::memory_order_acq_rel)) return;
+
+        std::vector<std::function<void()>> hooks;
+        {
+            std::lock_guard lock(stopMutex_);
+            hooks.swap(stopHooks_);
+        }
+        for (const auto &hook : hooks) hook();
+    }
+
+    void Pipeline::join() {
+        for (std::thread &t : threads_)
+            if (t.joinable()) t.join();
+
+        if (failure_) std::rethrow_exception(failure_);
+    }
+}
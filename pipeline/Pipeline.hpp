@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StageStats.hpp"
+
+namespace pipeline {
+    // Runs every registered stage on its own thread. Stages are expected to
+    // block on their input (channel or frame ring) instead of polling and to
+    // leave their loop once stopRequested() becomes true.
+    class Pipeline {
+    public:
+        using StageBody = std::function<void(Pipeline &)>;
+
+        Pipeline() = default;
+        Pipeline(const Pipeline &) = delete;
+        Pipeline &operator=(const Pipeline &) = delete;
+        ~Pipeline();
+
+        void addStage(const std::string &name, StageBody body);
+        // Hooks are called once on stop, they should wake up blocked stages.
+        void onStop(std::function<void()> hook);
+
+        void start();
+        void requestStop();
+        bool stopRequested() const { return stopRequested_.load(std::memory_order_acquire); }
+        // Waits for all stages, rethrows the first exception escaped from a stage.
+        void join();
+        // Timing of the stage registered under the name, throws std::out_of_range
+        // for unknown names.
+        StageStats &stats(const std::string &name);
+        // Stage names in registration order together with their timing.
+        std::vector<std::pair<std::string, const StageStats *>> allStats() const;
+
+        // Name of the stage which has thrown first, empty if none did.
+        const std::string &failedStage() const { return failedStage_; }
+
+    private:
+        struct Stage {
+            std::string name;
+            StageBody body;
+            std::unique_ptr<StageStats> stats;
+        };
+
+        std::vector<Stage> stages_;
+        std::vector<std::thread> threads_;
+        std::vector<std::function<void()>> stopHooks_;
+        std::mutex stopMutex_;
+        std::atomic_bool stopRequested_ = false;
+        std::exception_ptr failure_;
+        std::string failedStage_;
+    };
+}
@@ -0,0 +1,41 @@
+#include "StageStats.hpp"
+
+namespace pipeline {
+    namespace {
+        // Weight of the newest sample in recentMs()
+        const double RECENT_WEIGHT = 0.1;
+    }
+
+    void StageStats::start() {
+        started_.store(Clock::now(), std::memory_order_relaxed);
+    }
+
+    void StageStats::record(Clock::duration busy) {
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count();
+        const double ms = ns / 1e6;
+        const uint64_t count = processed_.load(std::memory_order_relaxed);
+        const double recent = count == 0 ? ms :
+            recentMs_.load(std::memory_order_relaxed) * (1.0 - RECENT_WEIGHT) + ms * RECENT_WEIGHT;
+
+        recentMs_.store(recent, std::memory_order_relaxed);
+        busyNs_.fetch_add(ns, std::memory_order_relaxed);
+        processed_.store(count + 1, std::memory_order_relaxed);
+    }
+
+    double StageStats::averageMs() const {
+        const uint64_t count = this->processed();
+        if (count == 0) return 0.0;
+
+        return busyNs_.load(std::memory_order_relaxed) / 1e6 / count;
+    }
+
+    double StageStats::utilization() const {
+        const Clock::time_point started = started_.load(std::memory_order_relaxed);
+        if (started == Clock::time_point()) return 0.0;
+
+        const int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+        if (wallNs <= 0) return 0.0;
+
+        return static_cast<double>(busyNs_.load(std::memory_order_relaxed)) / wallNs;
+    }
+}
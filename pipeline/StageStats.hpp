@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace pipeline {
+    // Timing of a single stage. Only the stage thread records, any thread may
+    // read, so plain atomics are enough.
+    class StageStats {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        StageStats() = default;
+
+        // Starts the wall time utilization() is measured against, called by
+        // Pipeline::start() so setup before the threads run isn't counted.
+        void start();
+        void record(Clock::duration busy);
+
+        uint64_t processed() const { return processed_.load(std::memory_order_relaxed); }
+        // Mean time spent on one item since the start, milliseconds.
+        double averageMs() const;
+        // Exponentially weighted time of the last items, milliseconds.
+        double recentMs() const { return recentMs_.load(std::memory_order_relaxed); }
+        // Share of the wall time since start() spent working rather than
+        // waiting for input.
+        double utilization() const;
+
+    private:
+        std::atomic<Clock::time_point> started_ = Clock::time_point();
+        std::atomic_uint64_t processed_ = 0;
+        std::atomic_int64_t busyNs_ = 0;
+        std::atomic<double> recentMs_ = 0.0;
+    };
+
+    // Records time between construction and destruction into the stage stats.
+    class ScopedStageTimer {
+    public:
+        explicit ScopedStageTimer(StageStats &stats) : stats_(stats), started_(StageStats::Clock::now()) {}
+        ~ScopedStageTimer() { stats_.record(StageStats::Clock::now() - started_); }
+        ScopedStageTimer(const ScopedStageTimer &) = delete;
+        ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+    private:
+        StageStats &stats_;
+        const StageStats::Clock::time_point started_;
+    };
+}
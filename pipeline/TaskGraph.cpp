@@ -0,0 +1,95 @@
+#include "TaskGraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace pipeline {
+    size_t TaskGraph::add(const std::string &name, Task task, const std::vector<size_t> &dependencies) {
+        for (size_t dependency : dependencies)
+            if (dependency >= nodes_.size())
+                throw std::invalid_argument("Step '" + name + "' depends on a step which is not added yet.");
+
+        nodes_.push_back({ name, std::move(task), dependencies });
+
+        return nodes_.size() - 1;
+    }
+
+    void TaskGraph::run() {
+        using clock = std::chrono::steady_clock;
+        const clock::time_point begin = clock::now();
+        const auto sinceBegin = [begin] {
+            return std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+        };
+
+        // Running the graph again runs every step again.
+        for (Node &node : nodes_) {
+            node.state = State::Pending;
+            node.startMs = node.durationMs = 0.0;
+        }
+
+        std::mutex mutex;
+        std::condition_variable finishedCv;
+        std::vector<std::thread> threads;
+        std::exception_ptr failure;
+        size_t finished = 0;
+
+        std::unique_lock lock(mutex);
+        while (finished < nodes_.size()) {
+            for (size_t i = 0; i < nodes_.size(); i++) {
+                Node &node = nodes_[i];
+                if (node.state != State::Pending) continue;
+
+                const auto depState = [this](size_t dependency) { return nodes_[dependency].state; };
+                const bool blocked = std::any_of(node.dependencies.cbegin(), node.dependencies.cend(),
+                        [&](size_t d) { return depState(d) == State::Failed || depState(d) == State::Skipped; });
+                const bool ready = std::all_of(node.dependencies.cbegin(), node.dependencies.cend(),
+                        [&](size_t d) { return depState(d) == State::Done; });
+                if (blocked) {
+                    node.state = State::Skipped;
+                    finished++;
+                    // Steps depending on this one may come earlier, scan again.
+                    i = static_cast<size_t>(-1);
+                }
+                else if (ready) {
+                    node.state = State::Running;
+                    node.startMs = sinceBegin();
+                    threads.emplace_back([&, i] {
+                        Node &running = nodes_[i];
+                        std::exception_ptr error;
+                        try {
+                            running.task();
+                        }
+                        catch (...) {
+                            error = std::current_exception();
+                        }
+
+                        std::lock_guard finishLock(mutex);
+                        running.durationMs = sinceBegin() - running.startMs;
+                        running.state = error ? State::Failed : State::Done;
+                        if (error && !failure) failure = error;
+                        finished++;
+                        finishedCv.notify_all();
+                    });
+                }
+            }
+            if (finished < nodes_.size()) finishedCv.wait(lock);
+        }
+        lock.unlock();
+
+        for (std::thread &t : threads) t.join();
+        if (failure) std::rethrow_exception(failure);
+    }
+
+    std::vector<TaskGraph::Timing> TaskGraph::timings() const {
+        std::vector<Timing> all;
+        for (const Node &node : nodes_)
+            all.push_back({ node.name, node.startMs, node.durationMs, node.state == State::Done });
+
+        return all;
+    }
+}
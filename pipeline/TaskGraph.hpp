@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pipeline {
+    // Runs one-off steps (e.g. application startup) concurrently while keeping
+    // the order between dependent ones. Every step gets its own thread as soon
+    // as all steps it depends on have finished. A failed step skips everything
+    // depending on it, the others still run to the end.
+    class TaskGraph {
+    public:
+        using Task = std::function<void()>;
+
+        struct Timing {
+            std::string name;
+            // Since run() was called, zero for skipped steps.
+            double startMs;
+            double durationMs;
+            bool done;
+        };
+
+        // Dependencies are ids returned by earlier add() calls, so there can't be a cycle.
+        size_t add(const std::string &name, Task task, const std::vector<size_t> &dependencies = {});
+
+        // Blocks until every step has finished or was skipped, then rethrows the
+        // first exception escaped from a step. Every call runs all steps anew.
+        void run();
+
+        std::vector<Timing> timings() const;
+
+    private:
+        enum class State { Pending, Running, Done, Failed, Skipped };
+
+        struct Node {
+            std::string name;
+            Task task;
+            std::vector<size_t> dependencies;
+            State state = State::Pending;
+            double startMs = 0.0;
+            double durationMs = 0.0;
+        };
+
+        std::vector<Node> nodes_;
+    };
+}
@@ -5,9 +5,11 @@ out vec4 color;
 smooth in vec2 v_texCoord;
 
 uniform sampler2D u_texture;
+// Set when the texture holds BGR data uploaded as is
+uniform bool u_swapRB;
 
 void main()
 {
     vec4 texColor = texture(u_texture, v_texCoord);
-    color = texColor;
-}
\ No newline at end of file
+    color = u_swapRB ? texColor.bgra : texColor;
+}
@@ -0,0 +1,10 @@
+#version 430 core
+
+out vec4 color;
+
+uniform vec4 u_color;
+
+void main()
+{
+    color = u_color;
+}
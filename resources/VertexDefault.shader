@@ -5,8 +5,11 @@ layout(location = 1) in vec2 texCoord;
 
 smooth out vec2 v_texCoord;
 
+// Camera frames are stored top row first, flipping here saves a CPU copy
+uniform bool u_flipY;
+
 void main()
 {
     gl_Position = position;
-    v_texCoord = texCoord;
-}
\ No newline at end of file
+    v_texCoord = u_flipY ? vec2(texCoord.x, 1.0 - texCoord.y) : texCoord;
+}
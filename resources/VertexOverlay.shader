@@ -0,0 +1,20 @@
+#version 430 core
+
+// Unit rectangle outline: corner is (0|1, 0|1), inner marks the inner edge
+layout(location = 0) in vec2 corner;
+layout(location = 1) in float inner;
+// Per instance: x, y, width, height in frame pixels
+layout(location = 2) in vec4 rect;
+
+uniform vec2 u_frameSize;
+uniform float u_thickness;
+
+void main()
+{
+    vec2 thickness = min(vec2(u_thickness), rect.zw * 0.5);
+    vec2 inset = (1.0 - 2.0 * corner) * thickness * inner;
+    vec2 pixel = rect.xy + corner * rect.zw + inset;
+    // Frame pixels grow downwards, clip space upwards
+    vec2 ndc = pixel / u_frameSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
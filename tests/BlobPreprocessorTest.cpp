@@ -0,0 +1,84 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+
+#include "detect/BlobPreprocessor.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    // OpenCV resizes 8-bit images in fixed point and rounds back to 8 bits
+    // before the float conversion, the fused path stays in float.
+    const float TOLERANCE = 1.0f;
+    const cv::Scalar MEAN(104.0, 177.0, 123.0);
+
+    cv::Mat makeImage(int width, int height, uint32_t seed) {
+        cv::Mat image(height, width, CV_8UC3);
+        uint32_t state = seed;
+        for (int y = 0; y < height; y++) {
+            unsigned char *row = image.ptr(y);
+            for (int x = 0; x < width * 3; x++) {
+                state = state * 1664525u + 1013904223u;
+                row[x] = static_cast<unsigned char>(state >> 24);
+            }
+        }
+
+        return image;
+    }
+
+    void compare(const std::vector<cv::Mat> &images, cv::Size inputSize, bool useSimd) {
+        cv::Mat expected;
+        cv::dnn::blobFromImages(images, expected, 1.0, inputSize, MEAN, false, false);
+
+        detect::BlobPreprocessor preprocessor(inputSize, MEAN, useSimd);
+        cv::Mat blob;
+        preprocessor.run(images, blob);
+        if (!useSimd) CHECK(std::string(preprocessor.path()) == "scalar");
+
+        CHECK(blob.total() == expected.total());
+        if (blob.total() != expected.total()) return;
+
+        const float *actual = blob.ptr<float>();
+        const float *wanted = expected.ptr<float>();
+        float worst = 0.0f;
+        size_t worstAt = 0;
+        for (size_t i = 0; i < blob.total(); i++) {
+            const float error = std::fabs(actual[i] - wanted[i]);
+            if (error > worst) {
+                worst = error;
+                worstAt = i;
+            }
+        }
+        std::printf("%s path, %d images %dx%d -> %dx%d: max error %.3f\n", preprocessor.path(),
+                static_cast<int>(images.size()), images[0].cols, images[0].rows, inputSize.width, inputSize.height,
+                worst);
+        if (worst > TOLERANCE)
+            std::fprintf(stderr, "  element %zu: %f, expected %f\n", worstAt, actual[worstAt], wanted[worstAt]);
+        CHECK(worst <= TOLERANCE);
+    }
+}
+
+int main() {
+    // The scalar path first, then AVX2 or NEON where this CPU has them.
+    for (const bool useSimd : { false, true }) {
+        // 300 columns leave 4 for the scalar tail after 8-wide SIMD, 301 and
+        // 299 other remainders. The rightmost output columns always read the
+        // last source pixel, which the gather must not cross, so they take the
+        // tail too.
+        for (const cv::Size inputSize : { cv::Size(300, 300), cv::Size(301, 299), cv::Size(7, 5) }) {
+            compare({ makeImage(640, 480, 1u) }, inputSize, useSimd);
+            compare({ makeImage(1280, 720, 2u), makeImage(1280, 720, 3u) }, inputSize, useSimd);
+            compare({ makeImage(33, 17, 4u) }, inputSize, useSimd);
+            compare({ makeImage(300, 300, 5u) }, inputSize, useSimd);
+        }
+        // Images of different sizes in one batch rebuild the tables per image.
+        compare({ makeImage(640, 480, 6u), makeImage(320, 240, 7u), makeImage(640, 480, 8u) }, cv::Size(300, 300),
+                useSimd);
+    }
+
+    return test::result();
+}
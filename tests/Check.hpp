@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the test executables, every test is its own program
+// which returns non-zero if any check failed.
+namespace test {
+    inline int failures = 0;
+
+    inline int result() {
+        if (failures) std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return failures ? 1 : 0;
+    }
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            test::failures++; \
+        } \
+    } while (false)
@@ -0,0 +1,196 @@
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "detect/DetectionWriter.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+
+    // Just enough of a JSON parser to tell a well formed line from a broken one.
+    class JsonChecker {
+    public:
+        explicit JsonChecker(const std::string &text) : text_(text) {}
+
+        bool valid() {
+            return this->value() && pos_ == text_.size();
+        }
+
+    private:
+        bool value() {
+            if (pos_ >= text_.size()) return false;
+            switch (text_[pos_]) {
+                case '{': return this->container('}', true);
+                case '[': return this->container(']', false);
+                case '"': return this->string();
+                case 't': return this->literal("true");
+                case 'f': return this->literal("false");
+                case 'n': return this->literal("null");
+                default: return this->number();
+            }
+        }
+
+        bool container(char close, bool isObject) {
+            pos_++;
+            if (pos_ < text_.size() && text_[pos_] == close) {
+                pos_++;
+                return true;
+            }
+            for (;;) {
+                if (isObject && (!this->string() || !this->expect(':'))) return false;
+                if (!this->value()) return false;
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    pos_++;
+                    continue;
+                }
+                return this->expect(close);
+            }
+        }
+
+        bool string() {
+            if (!this->expect('"')) return false;
+            while (pos_ < text_.size() && text_[pos_] != '"') {
+                if (text_[pos_] == '\\' || static_cast<unsigned char>(text_[pos_]) < 0x20) return false;
+                pos_++;
+            }
+            return this->expect('"');
+        }
+
+        bool literal(const char *word) {
+            const size_t size = std::strlen(word);
+            if (text_.compare(pos_, size, word) != 0) return false;
+            pos_ += size;
+            return true;
+        }
+
+        bool number() {
+            const char *begin = text_.c_str() + pos_;
+            char *end = nullptr;
+            std::strtod(begin, &end);
+            if (end == begin) return false;
+            pos_ += static_cast<size_t>(end - begin);
+            return true;
+        }
+
+        bool expect(char c) {
+            if (pos_ >= text_.size() || text_[pos_] != c) return false;
+            pos_++;
+            return true;
+        }
+
+        const std::string &text_;
+        size_t pos_ = 0;
+    };
+
+    // Number after "name": in a line, NaN if it is not there.
+    double field(const std::string &line, const std::string &name) {
+        const std::string key = '"' + name + "\":";
+        const size_t at = line.find(key);
+        if (at == std::string::npos) return std::nan("");
+        return std::strtod(line.c_str() + at + key.size(), nullptr);
+    }
+
+    std::vector<std::string> readLines(const fs::path &path) {
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+
+    detect::Track track(int id, float x, float y, float w, float h, float confidence) {
+        detect::Track t {};
+        t.id = id;
+        t.box = cv::Rect2f(x, y, w, h);
+        t.confidence = confidence;
+        return t;
+    }
+
+    void writesOneLinePerFrame() {
+        const fs::path path = fs::temp_directory_path() / "gb-detection-writer-test.jsonl";
+        {
+            detect::DetectionWriter writer(path.string());
+            const Clock::time_point captured = Clock::now() - std::chrono::milliseconds(40);
+            const auto wallBefore = std::chrono::system_clock::now();
+            writer.write(0, 7, captured, true, { track(3, 10.0f, 20.0f, 64.0f, 80.0f, 0.97f),
+                    track(4, 300.0f, 5.0f, 32.0f, 32.0f, 0.5f) });
+
+            // Flushed per line, readable while the writer is still open.
+            std::vector<std::string> lines = readLines(path);
+            CHECK(lines.size() == 1);
+            if (lines.size() == 1) {
+                const std::string &line = lines[0];
+                CHECK(JsonChecker(line).valid());
+                CHECK(line.rfind("{\"stream\":0,\"sequence\":7,\"time\":", 0) == 0);
+                CHECK(line.find("\"detected\":true") != std::string::npos);
+                CHECK(line.find("\"boxes\":[{\"id\":3,\"x\":10,\"y\":20,\"w\":64,\"h\":80,\"confidence\":0.970},"
+                        "{\"id\":4,\"x\":300,\"y\":5,\"w\":32,\"h\":32,\"confidence\":0.500}]}") != std::string::npos);
+
+                // Captured about 40 ms before the wall clock at the call.
+                const double wallMs = std::chrono::duration<double, std::milli>(wallBefore.time_since_epoch()).count();
+                const double time = field(line, "time");
+                CHECK(time > wallMs - 1000.0 && time <= wallMs);
+                const double latencyMs = field(line, "latencyMs");
+                CHECK(latencyMs >= 40.0 && latencyMs < 1000.0);
+            }
+
+            writer.write(1, 8, Clock::now(), false, {});
+            lines = readLines(path);
+            CHECK(lines.size() == 2);
+            if (lines.size() == 2) {
+                CHECK(JsonChecker(lines[1]).valid());
+                CHECK(lines[1].rfind("{\"stream\":1,\"sequence\":8,", 0) == 0);
+                CHECK(lines[1].find("\"detected\":false,\"boxes\":[]}") != std::string::npos);
+            }
+            CHECK(writer.written() == 2);
+        }
+        fs::remove(path);
+    }
+
+    void throwsWhenReaderGone() {
+        const fs::path path = fs::temp_directory_path() / "gb-detection-writer-test.fifo";
+        fs::remove(path);
+        CHECK(::mkfifo(path.c_str(), 0600) == 0);
+        // Opening the writing end blocks until there is a reader.
+        const int reader = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        CHECK(reader >= 0);
+        {
+            detect::DetectionWriter writer(path.string());
+            writer.write(0, 1, Clock::now(), true, {});
+            char buffer[256];
+            const ssize_t got = ::read(reader, buffer, sizeof(buffer));
+            CHECK(got > 0 && buffer[got - 1] == '\n');
+
+            ::close(reader);
+            bool threw = false;
+            try {
+                writer.write(0, 2, Clock::now(), true, {});
+            }
+            catch (const std::runtime_error &) {
+                threw = true;
+            }
+            CHECK(threw);
+            CHECK(writer.written() == 1);
+        }
+        fs::remove(path);
+    }
+}
+
+int main() {
+    // As in the application, a gone reader shows up as a failed write.
+    std::signal(SIGPIPE, SIG_IGN);
+    writesOneLinePerFrame();
+    throwsWhenReaderGone();
+    return test::result();
+}
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <filesystem>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "vidIO/FileCameraAdapter.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void mixedSizesKeepTheFirst() {
+        const fs::path dir = fs::temp_directory_path() / "gb-file-camera-test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        // Sorted by name: the first image sets the size, then a larger and a smaller one.
+        cv::imwrite((dir / "0.png").string(), cv::Mat(120, 160, CV_8UC3, cv::Scalar(10, 20, 30)));
+        cv::imwrite((dir / "1.png").string(), cv::Mat(480, 640, CV_8UC3, cv::Scalar(40, 50, 60)));
+        cv::imwrite((dir / "2.png").string(), cv::Mat(30, 50, CV_8UC3, cv::Scalar(70, 80, 90)));
+
+        {
+            vidIO::FileCameraAdapter adapter(dir, vidIO::Pacing::AsFastAsPossible);
+            CHECK(adapter.frameData().width == 160);
+            CHECK(adapter.frameData().height == 120);
+
+            // Stands in for a ring slot, its storage must never be replaced.
+            vidIO::Frame slot(120, 160, CV_8UC3);
+            const uchar *storage = slot.data;
+            const cv::Vec3b expected[] = { { 10, 20, 30 }, { 40, 50, 60 }, { 70, 80, 90 } };
+            for (const cv::Vec3b &color : expected) {
+                const auto before = std::chrono::steady_clock::now();
+                adapter.nextFrame(slot);
+                // Stamped when the frame was handed over.
+                CHECK(adapter.grabbed() >= before && adapter.grabbed() <= std::chrono::steady_clock::now());
+                CHECK(slot.cols == 160 && slot.rows == 120);
+                CHECK(slot.data == storage);
+                CHECK(slot.at<cv::Vec3b>(60, 80) == color);
+            }
+
+            bool ended = false;
+            try {
+                adapter.nextFrame(slot);
+            }
+            catch (const vidIO::EndOfStream &) {
+                ended = true;
+            }
+            CHECK(ended);
+        }
+        fs::remove_all(dir);
+    }
+}
+
+int main() {
+    mixedSizesKeepTheFirst();
+    return test::result();
+}
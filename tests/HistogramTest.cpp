@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "metrics/Histogram.hpp"
+#include "metrics/LatencyTrace.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using metrics::Histogram;
+    using metrics::LatencyTrace;
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+
+    // Percentiles are promised within 1/16 of the true value.
+    bool within(double value, double expected) {
+        return std::abs(value - expected) <= expected / 16.0 + 1e-9;
+    }
+
+    void percentiles() {
+        Histogram histogram;
+        CHECK(histogram.percentileUs(0.5) == 0.0);
+        CHECK(histogram.meanUs() == 0.0);
+
+        for (uint64_t us = 1; us <= 1000; us++) histogram.recordUs(us);
+        CHECK(histogram.count() == 1000);
+        CHECK(histogram.maxUs() == 1000);
+        CHECK(histogram.meanUs() == 500.5);
+        CHECK(within(histogram.percentileUs(0.50), 500.0));
+        CHECK(within(histogram.percentileUs(0.95), 950.0));
+        CHECK(within(histogram.percentileUs(0.99), 990.0));
+        CHECK(histogram.percentileUs(1.0) <= 1000.0);
+
+        // Below 16 us every value has a bucket of its own.
+        Histogram small;
+        for (uint64_t us = 0; us < 16; us++) small.recordUs(us);
+        CHECK(small.percentileUs(0.0) == 0.0);
+        CHECK(small.percentileUs(0.5) == 7.0);
+        CHECK(small.percentileUs(1.0) == 15.0);
+
+        // Far out values keep the relative accuracy and never exceed the maximum.
+        Histogram large;
+        large.record(std::chrono::seconds(10));
+        large.record(milliseconds(-5));
+        CHECK(large.count() == 2);
+        CHECK(within(large.percentileUs(1.0), 10e6));
+        CHECK(large.percentileUs(1.0) <= 10e6);
+        CHECK(large.percentileUs(0.0) == 0.0);
+
+        const metrics::Percentiles summary = metrics::summarize(histogram);
+        CHECK(summary.count == 1000);
+        CHECK(within(summary.p50Ms, 0.5));
+        CHECK(summary.maxMs == 1.0);
+    }
+
+    void addAndReset() {
+        Histogram low, high;
+        for (int i = 0; i < 100; i++) {
+            low.recordUs(100);
+            high.recordUs(10000);
+        }
+        low.add(high);
+        CHECK(low.count() == 200);
+        CHECK(low.maxUs() == 10000);
+        CHECK(within(low.percentileUs(0.25), 100.0));
+        CHECK(within(low.percentileUs(0.75), 10000.0));
+
+        low.reset();
+        CHECK(low.count() == 0);
+        CHECK(low.maxUs() == 0);
+        CHECK(low.percentileUs(0.5) == 0.0);
+    }
+
+    void concurrentRecords() {
+        Histogram histogram;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&histogram, t] {
+                for (uint64_t i = 0; i < 50000; i++) histogram.recordUs(i % 100 + t);
+            });
+        }
+        for (std::thread &thread : threads) thread.join();
+        CHECK(histogram.count() == 200000);
+        CHECK(histogram.maxUs() == 102);
+    }
+
+    void latencyTrace() {
+        LatencyTrace trace({ "capture", "detect" });
+        CHECK(trace.stage("detect") == 1);
+        bool threw = false;
+        try {
+            trace.stage("render");
+        }
+        catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        CHECK(threw);
+
+        // Frames 30 ms old when detection started, which took 10 ms.
+        LatencyTrace::Recorder &recorder = trace.recorder();
+        const LatencyTrace::Clock::time_point captured = LatencyTrace::Clock::now();
+        for (uint64_t seq = 0; seq < 100; seq++) {
+            recorder.record(0, 0, seq, captured, captured, captured + milliseconds(1));
+            recorder.record(1, 0, seq, captured, captured + milliseconds(30), captured + milliseconds(40));
+        }
+
+        const std::vector<LatencyTrace::StageLatency> summary = trace.summary();
+        CHECK(summary.size() == 2);
+        if (summary.size() == 2) {
+            CHECK(summary[0].name == "capture");
+            CHECK(summary[0].sinceCapture.count == 100);
+            CHECK(within(summary[0].sinceCapture.p50Ms, 1.0));
+            CHECK(summary[1].name == "detect");
+            CHECK(within(summary[1].sinceCapture.p99Ms, 40.0));
+            CHECK(within(summary[1].inStage.p50Ms, 10.0));
+        }
+        CHECK(trace.dropped() == 0);
+    }
+
+    void dropsWhenFull() {
+        LatencyTrace trace({ "stage" });
+        LatencyTrace::Recorder &recorder = trace.recorder();
+        const LatencyTrace::Clock::time_point now = LatencyTrace::Clock::now();
+        // The ring holds 4096 events until the next collect().
+        for (int i = 0; i < 4096 + 10; i++) recorder.record(0, 0, 0, now, now, now);
+        CHECK(trace.dropped() == 10);
+
+        trace.collect();
+        recorder.record(0, 0, 0, now, now, now);
+        CHECK(trace.dropped() == 10);
+        CHECK(trace.summary()[0].inStage.count == 4097);
+    }
+
+    void windowsRoll() {
+        LatencyTrace trace({ "stage" }, milliseconds(30));
+        LatencyTrace::Recorder &recorder = trace.recorder();
+        const LatencyTrace::Clock::time_point now = LatencyTrace::Clock::now();
+        recorder.record(0, 0, 0, now, now, now + microseconds(500));
+        CHECK(trace.summary()[0].inStage.count == 1);
+
+        // Still there one window later, gone after the second.
+        std::this_thread::sleep_for(milliseconds(35));
+        CHECK(trace.summary()[0].inStage.count == 1);
+        std::this_thread::sleep_for(milliseconds(35));
+        CHECK(trace.summary()[0].inStage.count == 0);
+    }
+}
+
+int main() {
+    percentiles();
+    addAndReset();
+    concurrentRecords();
+    latencyTrace();
+    dropsWhenFull();
+    windowsRoll();
+    return test::result();
+}
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Serial/MpscQueue.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    void fifoAndFull() {
+        MpscQueue<int> queue(5);
+        CHECK(queue.capacity() == 8);
+
+        for (int i = 0; i < 8; i++) CHECK(queue.tryPush(i));
+        CHECK(!queue.tryPush(8));
+
+        int value = -1;
+        for (int i = 0; i < 8; i++) {
+            CHECK(queue.tryPop(value));
+            CHECK(value == i);
+        }
+        CHECK(!queue.tryPop(value));
+
+        // Wraps around the cells.
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 6; i++) CHECK(queue.tryPush(round * 10 + i));
+            for (int i = 0; i < 6; i++) {
+                CHECK(queue.tryPop(value));
+                CHECK(value == round * 10 + i);
+            }
+        }
+    }
+
+    void manyProducers() {
+        const int PRODUCERS = 4;
+        const uint32_t PER_PRODUCER = 20000;
+        MpscQueue<uint32_t> queue(64);
+
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&queue, p] {
+                for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                    // A full queue is reported at once, the producer retries.
+                    while (!queue.tryPush(p << 24 | i)) std::this_thread::yield();
+                }
+            });
+        }
+
+        // Every value exactly once and each producer's values in order.
+        std::vector<uint32_t> next(PRODUCERS, 0);
+        uint32_t received = 0, value = 0;
+        while (received < PRODUCERS * PER_PRODUCER) {
+            if (!queue.tryPop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const uint32_t producer = value >> 24;
+            CHECK(producer < PRODUCERS);
+            if (producer >= PRODUCERS) break;
+            CHECK((value & 0xFFFFFFu) == next[producer]);
+            next[producer] = (value & 0xFFFFFFu) + 1;
+            received++;
+        }
+        for (std::thread &producer : producers) producer.join();
+        CHECK(!queue.tryPop(value));
+    }
+}
+
+int main() {
+    fifoAndFull();
+    manyProducers();
+    return test::result();
+}
@@ -0,0 +1,151 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Serial/PortDiscovery.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void write(const fs::path &file, const std::string &value) {
+        fs::create_directories(file.parent_path());
+        std::ofstream(file) << value << '\n';
+    }
+
+    void link(const fs::path &target, const fs::path &link) {
+        fs::create_directories(link.parent_path());
+        fs::create_directories(target);
+        fs::create_directory_symlink(target, link);
+    }
+
+    // Registers a tty in /sys/class/tty whose device is deviceDir, and its node in /dev.
+    void addTty(const fs::path &root, const std::string &name, const fs::path &deviceDir,
+            const std::string &subsystem, const std::string &driver, bool withNode = true) {
+        const fs::path ttyDir = deviceDir / "tty" / name;
+        fs::create_directories(ttyDir);
+        if (!fs::exists(deviceDir / "subsystem")) {
+            link(root / "sys/bus" / subsystem, deviceDir / "subsystem");
+            link(root / "sys/bus" / subsystem / "drivers" / driver, deviceDir / "driver");
+        }
+        link(deviceDir, ttyDir / "device");
+        link(ttyDir, root / "sys/class/tty" / name);
+        if (withNode) write(root / "dev" / name, "");
+    }
+
+    // A tree as the kernel lays it out for a USB CDC device, USB serial
+    // adapters, a real and a phantom 8250 UART and a virtual console.
+    fs::path makeTree() {
+        const fs::path root = fs::canonical(fs::temp_directory_path()) / ("gb-ports-" + std::to_string(getpid()));
+        fs::remove_all(root);
+
+        const fs::path arduino = root / "sys/devices/pci0000:00/usb1/1-1";
+        write(arduino / "idVendor", "2341");
+        write(arduino / "idProduct", "0043");
+        write(arduino / "serial", "75833353035351F0E1A1");
+        write(arduino / "product", "Arduino Uno");
+        addTty(root, "ttyACM0", arduino / "1-1:1.0", "usb", "cdc_acm");
+        // In sysfs but its node is gone already, e.g. while unplugging.
+        const fs::path gone = root / "sys/devices/pci0000:00/usb1/1-3";
+        write(gone / "idVendor", "2341");
+        addTty(root, "ttyACM1", gone / "1-3:1.0", "usb", "cdc_acm", false);
+
+        // USB serial adapters without a product string, one level deeper.
+        for (const std::string name : { "ttyUSB10", "ttyUSB2" }) {
+            const fs::path adapter = root / "sys/devices/pci0000:00/usb2" / ("2-" + name.substr(6));
+            write(adapter / "idVendor", "0403");
+            write(adapter / "idProduct", "6001");
+            addTty(root, name, adapter / "interface" / name, "usb-serial", "ftdi_sio");
+        }
+
+        addTty(root, "ttyS4", root / "sys/devices/pnp0/00:05", "pnp", "serial");
+        addTty(root, "ttyS0", root / "sys/devices/platform/serial8250", "platform", "serial8250");
+        // Virtual console, no device behind it.
+        fs::create_directories(root / "sys/devices/virtual/tty/tty1");
+        link(root / "sys/devices/virtual/tty/tty1", root / "sys/class/tty/tty1");
+        write(root / "dev/tty1", "");
+
+        fs::create_directories(root / "dev/serial/by-id");
+        fs::create_symlink("../../ttyACM0", root / "dev/serial/by-id/usb-Arduino_Uno_75833353035351F0E1A1-if00");
+
+        return root;
+    }
+
+    void enumeratesTree() {
+        const fs::path root = makeTree();
+        const std::string dev = (root / "dev").string();
+        const std::vector<PortInfo> ports = PortDiscovery::enumerate(root.string());
+
+        std::vector<std::string> paths;
+        for (const PortInfo &port : ports) paths.push_back(port.path);
+        // Shortest first, so ttyUSB2 comes before ttyUSB10.
+        CHECK(paths == std::vector<std::string>({ dev + "/ttyS4", dev + "/ttyACM0", dev + "/ttyUSB2", dev + "/ttyUSB10" }));
+
+        if (ports.size() == 4) {
+            const PortInfo &uart = ports[0];
+            CHECK(uart.description == "serial");
+            CHECK(uart.vendorId == 0 && uart.productId == 0);
+            CHECK(uart.stableName.empty());
+
+            const PortInfo &arduino = ports[1];
+            CHECK(arduino.description == "Arduino Uno");
+            CHECK(arduino.vendorId == 0x2341);
+            CHECK(arduino.productId == 0x0043);
+            CHECK(arduino.serialNumber == "75833353035351F0E1A1");
+            CHECK(arduino.stableName == dev + "/serial/by-id/usb-Arduino_Uno_75833353035351F0E1A1-if00");
+
+            const PortInfo &adapter = ports[2];
+            CHECK(adapter.description == "ftdi_sio");
+            CHECK(adapter.vendorId == 0x0403);
+            CHECK(adapter.productId == 0x6001);
+            CHECK(adapter.serialNumber.empty());
+        }
+
+        fs::remove_all(root);
+    }
+
+    void matchesReplugged() {
+        PortInfo before;
+        before.path = "/dev/ttyACM0";
+        before.stableName = "/dev/serial/by-id/usb-Arduino_Uno_75833353035351F0E1A1-if00";
+        before.vendorId = 0x2341;
+        before.productId = 0x0043;
+        before.serialNumber = "75833353035351F0E1A1";
+
+        // Back under another path.
+        PortInfo after = before;
+        after.path = "/dev/ttyACM1";
+        CHECK(sameDevice(before, after));
+        // Without a by-id link the USB ids and serial number tell.
+        after.stableName.clear();
+        CHECK(sameDevice(before, after));
+        after.serialNumber = "0001";
+        CHECK(!sameDevice(before, after));
+
+        // Another board of the same kind on the old path is not it.
+        PortInfo other = before;
+        other.stableName = "/dev/serial/by-id/usb-Arduino_Uno_0001-if00";
+        other.serialNumber = "0001";
+        CHECK(!sameDevice(before, other));
+
+        // Connected to by path only, nothing else to go by.
+        PortInfo byPath;
+        byPath.path = "/dev/ttyACM0";
+        CHECK(sameDevice(byPath, before));
+        CHECK(!sameDevice(byPath, after));
+    }
+
+    void emptyWithoutSysfs() {
+        CHECK(PortDiscovery::enumerate("/nonexistent-gb-root").empty());
+    }
+}
+
+int main() {
+    enumeratesTree();
+    matchesReplugged();
+    emptyWithoutSysfs();
+    return test::result();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace test {
+    // Pseudo terminal standing in for a serial device. The test talks to the
+    // master side, the code under test opens the slave side by name.
+    struct Pty {
+        int master = -1;
+        int slave = -1;
+        std::string name;
+
+        Pty() {
+            char path[64];
+            if (openpty(&master, &slave, path, nullptr, nullptr) != 0)
+                throw std::runtime_error("openpty failed");
+            name = path;
+            termios tty;
+            tcgetattr(master, &tty);
+            cfmakeraw(&tty);
+            tcsetattr(master, TCSANOW, &tty);
+        }
+        Pty(const Pty &) = delete;
+        Pty &operator=(const Pty &) = delete;
+
+        ~Pty() {
+            if (master >= 0) ::close(master);
+            if (slave >= 0) ::close(slave);
+        }
+
+        // Reads until count bytes arrived or timeoutMs passed.
+        std::string readMaster(size_t count, int timeoutMs) {
+            std::string data;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (data.size() < count && std::chrono::steady_clock::now() < deadline) {
+                pollfd fd { master, POLLIN, 0 };
+                if (poll(&fd, 1, 10) <= 0) continue;
+                char buffer[256];
+                const ssize_t n = ::read(master, buffer, sizeof(buffer));
+                if (n > 0) data.append(buffer, static_cast<size_t>(n));
+            }
+            return data;
+        }
+
+        void writeMaster(const void *data, size_t size) {
+            if (::write(master, data, size) != static_cast<ssize_t>(size))
+                throw std::runtime_error("Writing to the pty failed");
+        }
+    };
+}
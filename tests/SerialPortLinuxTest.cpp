@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "Serial/SerialBaudLinux.hpp"
+#include "Serial/SerialPort.hpp"
+#include "tests/Check.hpp"
+#include "tests/Pty.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    using test::Pty;
+
+    long long msSince(Clock::time_point start) {
+        return std::chrono::duration_cast<milliseconds>(Clock::now() - start).count();
+    }
+
+    void writesArrive() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.open();
+
+        const std::string message = "\xA5\x01\x02\x00 servo";
+        port.write(message.data(), static_cast<uint32_t>(message.size()));
+        CHECK(pty.readMaster(message.size(), 1000) == message);
+    }
+
+    void readsWhatArrives() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(1000, 50);
+        port.open();
+
+        std::thread writer([&pty] {
+            std::this_thread::sleep_for(milliseconds(50));
+            pty.writeMaster("ack", 3);
+        });
+        char buffer[16];
+        const size_t n = port.readSome(buffer, sizeof(buffer));
+        CHECK(std::string(buffer, n) == "ack");
+        writer.join();
+    }
+
+    void readTimesOut() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(100, 50);
+        port.open();
+
+        char buffer[16];
+        const auto start = Clock::now();
+        CHECK(port.readSome(buffer, sizeof(buffer)) == 0);
+        const long long elapsed = msSince(start);
+        CHECK(elapsed >= 100);
+        CHECK(elapsed < 1000);
+    }
+
+    void closeUnblocksRead() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(10000, 50);
+        port.open();
+
+        const auto start = Clock::now();
+        auto pending = std::async(std::launch::async, [&port] {
+            char buffer[16];
+            return port.readSome(buffer, sizeof(buffer));
+        });
+        std::this_thread::sleep_for(milliseconds(100));
+        port.close();
+
+        CHECK(pending.wait_for(milliseconds(2000)) == std::future_status::ready);
+        CHECK(pending.get() == 0);
+        CHECK(msSince(start) < 2000);
+        CHECK(!port.isOpen());
+
+        // The port can be opened again after that.
+        port.open();
+        CHECK(port.isOpen());
+    }
+
+    void closeUnblocksWrite() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(50, 10000);
+        port.open();
+
+        // Nobody reads the master, the write stalls once the pty is full.
+        const auto start = Clock::now();
+        auto pending = std::async(std::launch::async, [&port] {
+            const std::string data(1 << 20, 'x');
+            try {
+                port.write(data.data(), static_cast<uint32_t>(data.size()));
+            }
+            catch (const std::runtime_error &e) {
+                return std::string(e.what());
+            }
+            return std::string();
+        });
+        std::this_thread::sleep_for(milliseconds(100));
+        port.close();
+
+        CHECK(pending.wait_for(milliseconds(2000)) == std::future_status::ready);
+        CHECK(pending.get().find("closed") != std::string::npos);
+        CHECK(msSince(start) < 2000);
+        CHECK(!port.isOpen());
+    }
+
+    void roundTripLatency() {
+        Pty pty;
+        SerialPort port(pty.name, SerialMode::ReadWrite, 115200u);
+        port.setTimeouts(1000, 1000);
+        port.open();
+
+        // The master echoes whatever arrives, like a device acking at once.
+        std::atomic_bool done = false;
+        std::thread echo([&pty, &done] {
+            char buffer[256];
+            while (!done.load()) {
+                pollfd fd { pty.master, POLLIN, 0 };
+                if (poll(&fd, 1, 10) <= 0) continue;
+                const ssize_t n = ::read(pty.master, buffer, sizeof(buffer));
+                if (n > 0) pty.writeMaster(buffer, static_cast<size_t>(n));
+            }
+        });
+
+        const std::string frame = "\xA5\x01\x02\x03\x00\x84\x03\x5C";
+        std::vector<double> micros;
+        for (int i = 0; i < 1000; i++) {
+            const auto start = Clock::now();
+            port.write(frame.data(), static_cast<uint32_t>(frame.size()));
+            std::string got;
+            while (got.size() < frame.size()) {
+                char buffer[16];
+                const size_t n = port.readSome(buffer, sizeof(buffer));
+                if (n == 0) break;
+                got.append(buffer, n);
+            }
+            CHECK(got == frame);
+            micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        done = true;
+        echo.join();
+
+        std::sort(micros.begin(), micros.end());
+        const double p50 = micros[micros.size() / 2];
+        const double p99 = micros[micros.size() * 99 / 100];
+        std::printf("pty round trip: p50 %.0f us, p99 %.0f us\n", p50, p99);
+        // Far below the 20 ms a servo command may take, the port itself must
+        // not add scheduler ticks.
+        CHECK(p50 < 1000.0);
+        CHECK(p99 < 10000.0);
+    }
+
+    void bulkThroughput() {
+        Pty pty;
+        SerialPort port(pty.name, SerialMode::ReadWrite, 115200u);
+        port.setTimeouts(50, 2000);
+        port.open();
+
+        const size_t total = 16u << 20;
+        size_t received = 0;
+        bool intact = true;
+        std::thread drain([&pty, &received, &intact] {
+            char buffer[4096];
+            const auto deadline = Clock::now() + std::chrono::seconds(20);
+            while (received < total && Clock::now() < deadline) {
+                pollfd fd { pty.master, POLLIN, 0 };
+                if (poll(&fd, 1, 10) <= 0) continue;
+                const ssize_t n = ::read(pty.master, buffer, sizeof(buffer));
+                for (ssize_t i = 0; i < n; i++)
+                    intact = intact && buffer[i] == static_cast<char>((received + i) % 251);
+                if (n > 0) received += static_cast<size_t>(n);
+            }
+        });
+
+        std::vector<char> chunk(64u << 10);
+        const auto start = Clock::now();
+        for (size_t sent = 0; sent < total; sent += chunk.size()) {
+            for (size_t i = 0; i < chunk.size(); i++) chunk[i] = static_cast<char>((sent + i) % 251);
+            port.write(chunk.data(), static_cast<uint32_t>(chunk.size()));
+        }
+        drain.join();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const double megabytes = static_cast<double>(received) / (1 << 20);
+        std::printf("pty throughput: %.0f MiB/s\n", megabytes / seconds);
+        CHECK(received == total);
+        CHECK(intact);
+        // A pty moves well over 100 MiB/s, a port waiting on the wrong
+        // events or sleeping between writes falls far behind.
+        CHECK(megabytes / seconds > 10.0);
+    }
+
+    void customBaudrate() {
+        Pty pty;
+        // 250000 has no Bxxx constant and goes through termios2.
+        SerialPort custom(pty.name, SerialMode::ReadWrite, 250000u);
+        custom.open();
+        CHECK(currentBaudrate(pty.slave) == 250000u);
+        const std::string message = "custom";
+        custom.write(message.data(), static_cast<uint32_t>(message.size()));
+        CHECK(pty.readMaster(message.size(), 1000) == message);
+        custom.close();
+
+        SerialPort standard(pty.name, SerialMode::ReadWrite, 115200u);
+        standard.open();
+        CHECK(currentBaudrate(pty.slave) == 115200u);
+    }
+
+    void hangUpThrows() {
+        Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(1000, 50);
+        port.open();
+        ::close(pty.slave);
+        pty.slave = -1;
+        ::close(pty.master);
+        pty.master = -1;
+
+        char buffer[16];
+        bool threw = false;
+        try {
+            port.readSome(buffer, sizeof(buffer));
+        }
+        catch (const std::runtime_error &) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
+
+int main() {
+    writesArrive();
+    readsWhatArrives();
+    readTimesOut();
+    closeUnblocksRead();
+    closeUnblocksWrite();
+    roundTripLatency();
+    bulkThroughput();
+    customBaudrate();
+    hangUpThrows();
+    return test::result();
+}
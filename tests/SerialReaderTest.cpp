@@ -0,0 +1,127 @@
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Serial/SerialReader.hpp"
+#include "Serial/SerialService.hpp"
+#include "Serial/ServoProtocol.hpp"
+#include "tests/Check.hpp"
+#include "tests/Pty.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    bool waitUntil(const std::function<bool()> &condition, int timeoutMs) {
+        const auto deadline = Clock::now() + milliseconds(timeoutMs);
+        while (!condition()) {
+            if (Clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        return true;
+    }
+
+    std::string ack(uint8_t seq, proto::Opcode opcode, proto::AckStatus status = proto::AckStatus::Ok) {
+        proto::Frame frame;
+        frame.seq = seq;
+        frame.opcode = proto::Opcode::Ack;
+        frame.size = 2;
+        frame.payload[0] = static_cast<uint8_t>(opcode);
+        frame.payload[1] = static_cast<uint8_t>(status);
+        char out[proto::MAX_FRAME_SIZE];
+        return std::string(out, proto::encode(frame, reinterpret_cast<uint8_t *>(out)));
+    }
+
+    void readsSplitFrames() {
+        test::Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(20, 50);
+        port.open();
+
+        std::mutex mutex;
+        std::vector<uint8_t> seqs;
+        SerialReader reader(port,
+                [&](const proto::FrameView &frame, Clock::time_point) {
+                    std::lock_guard lock(mutex);
+                    seqs.push_back(frame.seq());
+                },
+                [](const std::string &) {});
+
+        // Noise, a frame cut in two writes, a false sync byte and one more frame.
+        const std::string first = ack(1, proto::Opcode::SetAngle);
+        const std::string second = ack(2, proto::Opcode::Ping);
+        const std::string noise("\x00\x13", 2);
+        pty.writeMaster(noise.data(), noise.size());
+        pty.writeMaster(first.data(), 3);
+        std::this_thread::sleep_for(milliseconds(30));
+        pty.writeMaster(first.data() + 3, first.size() - 3);
+        const std::string rest = "\xA5\x7F" + second;
+        pty.writeMaster(rest.data(), rest.size());
+
+        CHECK(waitUntil([&] { return reader.frames() == 2; }, 2000));
+        std::lock_guard lock(mutex);
+        CHECK(seqs == std::vector<uint8_t>({ 1, 2 }));
+        CHECK(reader.skipped() == noise.size() + 2);
+        CHECK(reader.bytesRead() == noise.size() + first.size() + rest.size());
+    }
+
+    void reportsHangUp() {
+        test::Pty pty;
+        SerialPort port(pty.name);
+        port.setTimeouts(20, 50);
+        port.open();
+
+        std::mutex mutex;
+        std::string error;
+        SerialReader reader(port, [](const proto::FrameView &, Clock::time_point) {},
+                [&](const std::string &what) {
+                    std::lock_guard lock(mutex);
+                    error = what;
+                });
+        ::close(pty.slave);
+        pty.slave = -1;
+        ::close(pty.master);
+        pty.master = -1;
+
+        CHECK(waitUntil([&] {
+            std::lock_guard lock(mutex);
+            return !error.empty();
+        }, 2000));
+    }
+
+    void matchesAcks() {
+        test::Pty pty;
+        SerialService service(64u, proto::BAUDRATE);
+        service.connect(pty.name);
+        CHECK(waitUntil([&service] { return service.isConnected(); }, 2000));
+
+        // Two frames in flight, acked out of order, the second one refused.
+        service.sendFrame(proto::setAngle(10, 0, 20.0f));
+        service.sendFrame(proto::setAngle(11, 1, 40.0f));
+        CHECK(pty.readMaster(2 * (proto::HEADER_SIZE + 3 + 1), 2000).size() == 2 * (proto::HEADER_SIZE + 3 + 1));
+
+        const std::string acks = ack(11, proto::Opcode::SetAngle, proto::AckStatus::BadPayload)
+                + ack(10, proto::Opcode::SetAngle)
+                // Matches nothing in flight, neither does a second ack for 10.
+                + ack(99, proto::Opcode::SetAngle) + ack(10, proto::Opcode::SetAngle);
+        pty.writeMaster(acks.data(), acks.size());
+
+        CHECK(waitUntil([&service] { return service.status().strayAcks == 2; }, 2000));
+        const SerialServiceStatus status = service.status();
+        CHECK(status.acked == 2);
+        CHECK(status.refused == 1);
+        CHECK(status.unacked == 0);
+        CHECK(status.roundTrip.count == 2);
+        service.stop();
+    }
+}
+
+int main() {
+    readsSplitFrames();
+    reportsHangUp();
+    matchesAcks();
+    return test::result();
+}
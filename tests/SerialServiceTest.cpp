@@ -0,0 +1,121 @@
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Serial/SerialService.hpp"
+#include "Serial/ServoProtocol.hpp"
+#include "tests/Check.hpp"
+#include "tests/Pty.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    bool waitUntil(const std::function<bool()> &condition, int timeoutMs) {
+        const auto deadline = Clock::now() + milliseconds(timeoutMs);
+        while (!condition()) {
+            if (Clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        return true;
+    }
+
+    // Fills the pty towards the master until it takes no more, so the next
+    // write of the service blocks until the test reads.
+    void fillTowardsMaster(test::Pty &pty) {
+        fcntl(pty.slave, F_SETFL, fcntl(pty.slave, F_GETFL) | O_NONBLOCK);
+        const std::vector<char> zeros(4096, 0);
+        while (::write(pty.slave, zeros.data(), zeros.size()) > 0) {}
+    }
+
+    // Reads from the master and decodes frames until last() accepts one.
+    std::vector<proto::Frame> readFrames(test::Pty &pty, const std::function<bool(const proto::Frame &)> &last,
+            int timeoutMs) {
+        std::vector<proto::Frame> frames;
+        proto::Decoder decoder;
+        const auto deadline = Clock::now() + milliseconds(timeoutMs);
+        bool done = false;
+        while (!done && Clock::now() < deadline) {
+            for (const char byte : pty.readMaster(4096, 10)) {
+                decoder.push(static_cast<uint8_t>(byte), [&](const proto::Frame &frame) {
+                    frames.push_back(frame);
+                    done = done || last(frame);
+                });
+            }
+        }
+        return frames;
+    }
+
+    float degrees(const proto::Frame &frame) {
+        return static_cast<float>(frame.payload[1] | frame.payload[2] << 8) / 10.0f;
+    }
+
+    void coalescesQueuedAngles() {
+        test::Pty pty;
+        SerialService service(64u, proto::BAUDRATE);
+        service.connect(pty.name);
+        CHECK(waitUntil([&service] { return service.isConnected(); }, 2000));
+
+        // The I/O thread blocks writing this frame, the angles queue up
+        // behind it and are taken in one batch.
+        fillTowardsMaster(pty);
+        service.sendFrame(proto::ping(200));
+        std::this_thread::sleep_for(milliseconds(10));
+        for (int i = 0; i < 10; i++) {
+            service.sendFrame(proto::setAngle(static_cast<uint8_t>(i), 0, 10.0f * i));
+            // Another servo, not superseded by servo 0.
+            if (i == 4) service.sendFrame(proto::setAngle(100, 1, 45.0f));
+        }
+
+        const std::vector<proto::Frame> frames = readFrames(pty, [](const proto::Frame &frame) {
+            return frame.opcode == proto::Opcode::SetAngle && frame.payload[0] == 0;
+        }, 2000);
+        service.stop();
+
+        std::vector<proto::Frame> servo0, servo1;
+        for (const proto::Frame &frame : frames) {
+            if (frame.opcode != proto::Opcode::SetAngle) continue;
+            (frame.payload[0] == 0 ? servo0 : servo1).push_back(frame);
+        }
+        // Only the newest angle of servo 0 left the host.
+        CHECK(service.status().coalesced == 9);
+        CHECK(servo0.size() == 1);
+        if (servo0.size() == 1) {
+            CHECK(servo0[0].seq == 9);
+            CHECK(degrees(servo0[0]) == 90.0f);
+        }
+        CHECK(servo1.size() == 1);
+        if (servo1.size() == 1) CHECK(degrees(servo1[0]) == 45.0f);
+    }
+
+    void sendsInOrderWhenIdle() {
+        test::Pty pty;
+        SerialService service(64u, proto::BAUDRATE);
+        service.connect(pty.name);
+        CHECK(waitUntil([&service] { return service.isConnected(); }, 2000));
+
+        // Nothing to coalesce when every write leaves before the next one.
+        std::vector<proto::Frame> frames;
+        for (int i = 0; i < 3; i++) {
+            service.sendFrame(proto::setAngle(static_cast<uint8_t>(i), 0, 30.0f * i));
+            const std::vector<proto::Frame> got = readFrames(pty, [](const proto::Frame &) { return true; }, 2000);
+            frames.insert(frames.end(), got.begin(), got.end());
+        }
+        service.stop();
+
+        CHECK(service.status().coalesced == 0);
+        CHECK(frames.size() == 3);
+        for (size_t i = 0; i < frames.size(); i++) CHECK(degrees(frames[i]) == 30.0f * i);
+    }
+}
+
+int main() {
+    coalescesQueuedAngles();
+    sendsInOrderWhenIdle();
+    return test::result();
+}
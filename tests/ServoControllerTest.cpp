@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+
+#include "control/ServoController.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using control::Clock;
+    using control::ServoController;
+    using control::ServoTarget;
+    using std::chrono::milliseconds;
+
+    const auto PERIOD = milliseconds(20);
+
+    ServoTarget targetAt(float offset, Clock::time_point captured) {
+        ServoTarget target;
+        target.valid = true;
+        target.offset = offset;
+        target.captured = captured;
+        return target;
+    }
+
+    void holdsWithoutFreshTarget() {
+        ServoController controller(90.0f);
+        Clock::time_point now = Clock::now();
+        controller.reset(90.0f, now);
+
+        for (int i = 0; i < 10; i++) {
+            now += PERIOD;
+            CHECK(controller.update(ServoTarget(), now) == 90.0f);
+        }
+
+        // Captured longer than lostAfterMs ago.
+        const ServoTarget stale = targetAt(1.0f, now - milliseconds(600));
+        for (int i = 0; i < 10; i++) {
+            now += PERIOD;
+            CHECK(controller.update(stale, now) == 90.0f);
+        }
+        CHECK(controller.error() == 0.0f);
+    }
+
+    void deadbandAndDirection() {
+        Clock::time_point now = Clock::now();
+
+        // 0.04 of half the field of view is 1.2 degrees, below the deadband.
+        ServoController still(90.0f);
+        still.reset(90.0f, now);
+        for (int i = 0; i < 10; i++) {
+            now += PERIOD;
+            CHECK(still.update(targetAt(0.04f, now), now) == 90.0f);
+        }
+
+        ServoController right(90.0f);
+        right.reset(90.0f, now);
+        now += PERIOD;
+        CHECK(right.update(targetAt(0.5f, now), now) > 90.0f);
+
+        ServoController::Params params;
+        params.inverted = true;
+        ServoController inverted(params, 90.0f);
+        inverted.reset(90.0f, now);
+        now += PERIOD;
+        CHECK(inverted.update(targetAt(0.5f, now), now) < 90.0f);
+    }
+
+    void rateAndRangeLimited() {
+        ServoController::Params params;
+        params.maxRateDegPerS = 50.0f;
+        ServoController controller(params, 170.0f);
+        Clock::time_point now = Clock::now();
+        controller.reset(170.0f, now);
+
+        float previous = controller.angle();
+        for (int i = 0; i < 50; i++) {
+            now += PERIOD;
+            // A face at the right border, always fresh.
+            const float angle = controller.update(targetAt(1.0f, now), now);
+            CHECK(angle - previous <= 50.0f * 0.020f + 1e-3f);
+            CHECK(angle <= params.maxAngle);
+            previous = angle;
+        }
+        CHECK(controller.angle() == params.maxAngle);
+    }
+
+    void correctsForMovementSinceCapture() {
+        Clock::time_point now = Clock::now();
+        ServoController controller(90.0f);
+        controller.reset(90.0f, now);
+
+        // A face 15 degrees to the right, the servo starts turning.
+        const Clock::time_point captured = now;
+        const ServoTarget target = targetAt(0.5f, captured);
+        for (int i = 0; i < 5; i++) {
+            now += PERIOD;
+            controller.update(target, now);
+        }
+        const float turned = controller.angle() - 90.0f;
+        CHECK(turned > 2.0f);
+
+        // The same old measurement again, the servo already covered part of it.
+        now += PERIOD;
+        controller.update(target, now);
+        CHECK(std::abs(controller.error() - (15.0f - turned)) < 0.5f);
+    }
+
+    void followsWithoutOvershoot() {
+        // The camera sees a face at a fixed bearing through a detector which
+        // is 100 ms late, the servo follows the commanded angle at once.
+        const float FACE = 130.0f;
+        const float HALF_FOV = 30.0f;
+        const auto LATENCY = milliseconds(100);
+
+        Clock::time_point now = Clock::now();
+        ServoController controller(90.0f);
+        controller.reset(90.0f, now);
+
+        struct Shot {
+            Clock::time_point time;
+            float angle;
+        };
+        std::deque<Shot> shots;
+        float peak = 90.0f;
+        for (int i = 0; i < 300; i++) {
+            now += PERIOD;
+            shots.push_back({ now, controller.angle() });
+
+            ServoTarget target;
+            while (shots.size() > 1 && now - shots.front().time >= LATENCY) {
+                target = targetAt((FACE - shots.front().angle) / HALF_FOV, shots.front().time);
+                shots.pop_front();
+            }
+            peak = std::max(peak, controller.update(target, now));
+        }
+
+        CHECK(std::abs(controller.angle() - FACE) <= ServoController::Params().deadbandDeg + 0.5f);
+        CHECK(peak < FACE + 3.0f);
+    }
+}
+
+int main() {
+    holdsWithoutFreshTarget();
+    deadbandAndDirection();
+    rateAndRangeLimited();
+    correctsForMovementSinceCapture();
+    followsWithoutOvershoot();
+    return test::result();
+}
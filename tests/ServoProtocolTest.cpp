@@ -0,0 +1,202 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Serial/ServoProtocol.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using Bytes = std::vector<uint8_t>;
+
+    Bytes encoded(const proto::Frame &frame) {
+        Bytes out(proto::MAX_FRAME_SIZE);
+        out.resize(proto::encode(frame, out.data()));
+        return out;
+    }
+
+    std::vector<proto::Frame> decode(proto::Decoder &decoder, const Bytes &bytes) {
+        std::vector<proto::Frame> frames;
+        for (const uint8_t byte : bytes)
+            decoder.push(byte, [&frames](const proto::Frame &frame) { frames.push_back(frame); });
+        return frames;
+    }
+
+    bool same(const proto::Frame &a, const proto::Frame &b) {
+        if (a.seq != b.seq || a.opcode != b.opcode || a.size != b.size) return false;
+        for (size_t i = 0; i < a.size; i++)
+            if (a.payload[i] != b.payload[i]) return false;
+        return true;
+    }
+
+    // Reference the decoder must agree with: a valid frame is taken whole,
+    // an invalid one skips its sync byte and the scan stops at a frame still
+    // waiting for bytes.
+    std::vector<proto::Frame> scan(const Bytes &bytes) {
+        std::vector<proto::Frame> frames;
+        size_t pos = 0;
+        while (pos < bytes.size()) {
+            if (bytes[pos] != proto::SYNC) {
+                pos++;
+                continue;
+            }
+            const size_t left = bytes.size() - pos;
+            if (left < proto::HEADER_SIZE) break;
+            const size_t size = bytes[pos + 3];
+            if (size > proto::MAX_PAYLOAD) {
+                pos++;
+                continue;
+            }
+            if (left < proto::HEADER_SIZE + size + 1) break;
+            if (proto::crc8(&bytes[pos + 1], proto::HEADER_SIZE - 1 + size) != bytes[pos + proto::HEADER_SIZE + size]) {
+                pos++;
+                continue;
+            }
+            proto::Frame frame;
+            frame.seq = bytes[pos + 1];
+            frame.opcode = static_cast<proto::Opcode>(bytes[pos + 2]);
+            frame.size = static_cast<uint8_t>(size);
+            for (size_t i = 0; i < size; i++) frame.payload[i] = bytes[pos + proto::HEADER_SIZE + i];
+            frames.push_back(frame);
+            pos += proto::HEADER_SIZE + size + 1;
+        }
+        return frames;
+    }
+
+    proto::Frame randomFrame(std::mt19937 &rng) {
+        proto::Frame frame;
+        frame.seq = static_cast<uint8_t>(rng());
+        frame.opcode = static_cast<proto::Opcode>(rng() % 2 ? 0x02 : 0x80);
+        frame.size = static_cast<uint8_t>(rng() % (proto::MAX_PAYLOAD + 1));
+        for (size_t i = 0; i < frame.size; i++)
+            frame.payload[i] = rng() % 4 ? static_cast<uint8_t>(rng()) : proto::SYNC;
+        return frame;
+    }
+
+    void roundTrip() {
+        std::mt19937 rng(1);
+        proto::Decoder decoder;
+        for (size_t size = 0; size <= proto::MAX_PAYLOAD; size++) {
+            proto::Frame frame = randomFrame(rng);
+            frame.size = static_cast<uint8_t>(size);
+            const std::vector<proto::Frame> frames = decode(decoder, encoded(frame));
+            CHECK(frames.size() == 1);
+            if (frames.size() == 1) CHECK(same(frames[0], frame));
+        }
+        CHECK(decoder.frames() == proto::MAX_PAYLOAD + 1);
+        CHECK(decoder.crcErrors() == 0);
+        CHECK(decoder.lengthErrors() == 0);
+
+        // 90 degrees is 900 tenths, little endian.
+        const Bytes angle = encoded(proto::setAngle(7, 1, 90.0f));
+        CHECK(angle.size() == proto::HEADER_SIZE + 3 + 1);
+        CHECK(angle[0] == proto::SYNC && angle[1] == 7 && angle[2] == 0x02 && angle[3] == 3);
+        CHECK(angle[4] == 1 && angle[5] == (900 & 0xFF) && angle[6] == (900 >> 8));
+        CHECK(encoded(proto::setAngle(0, 0, 250.0f))[5] == (1800 & 0xFF));
+        CHECK(proto::coalescingKey(proto::setAngle(1, 2, 10.0f)) == proto::coalescingKey(proto::setAngle(9, 2, 50.0f)));
+        CHECK(proto::coalescingKey(proto::setAngle(1, 2, 10.0f)) != proto::coalescingKey(proto::setAngle(1, 3, 10.0f)));
+        CHECK(proto::coalescingKey(proto::ping(1)) == 0);
+    }
+
+    void rejectsBadCrc() {
+        const proto::Frame good = proto::setAngle(3, 0, 45.0f);
+        Bytes corrupt = encoded(good);
+        corrupt.back() ^= 0x01;
+
+        proto::Decoder decoder;
+        CHECK(decode(decoder, corrupt).empty());
+        CHECK(decoder.crcErrors() == 1);
+
+        const std::vector<proto::Frame> frames = decode(decoder, encoded(good));
+        CHECK(frames.size() == 1);
+        if (frames.size() == 1) CHECK(same(frames[0], good));
+    }
+
+    void rejectsBadLength() {
+        // A sync byte with a length over MAX_PAYLOAD right in front of a frame.
+        Bytes bytes = { proto::SYNC, 0x01, 0x02, static_cast<uint8_t>(proto::MAX_PAYLOAD + 1) };
+        const proto::Frame good = proto::ping(42);
+        const Bytes frame = encoded(good);
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+        proto::Decoder decoder;
+        const std::vector<proto::Frame> frames = decode(decoder, bytes);
+        CHECK(decoder.lengthErrors() == 1);
+        CHECK(frames.size() == 1);
+        if (frames.size() == 1) CHECK(same(frames[0], good));
+    }
+
+    void resyncsInsideFalseFrame() {
+        // The false sync byte claims a length which swallows the real frame,
+        // the CRC fails and the real frame is found on the rescan.
+        const proto::Frame good = proto::setAngle(5, 1, 120.0f);
+        const Bytes frame = encoded(good);
+        Bytes bytes = { 0x00, proto::SYNC, 0x11, 0x22, static_cast<uint8_t>(frame.size() - 2) };
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+        proto::Decoder decoder;
+        const std::vector<proto::Frame> frames = decode(decoder, bytes);
+        CHECK(decoder.crcErrors() == 1);
+        CHECK(frames.size() == 1);
+        if (frames.size() == 1) CHECK(same(frames[0], good));
+    }
+
+    void fuzz() {
+        std::mt19937 rng(2024);
+        proto::Decoder decoder;
+        size_t expected = 0, found = 0;
+        for (int round = 0; round < 20000; round++) {
+            const proto::Frame frame = randomFrame(rng);
+            const Bytes tail = encoded(frame);
+
+            // Noise heavy in sync bytes and small lengths, redrawn in the rare
+            // case it holds a valid frame of its own.
+            Bytes burst;
+            std::vector<proto::Frame> reference;
+            do {
+                burst.assign(rng() % 48, 0);
+                for (uint8_t &byte : burst) {
+                    const uint32_t kind = rng() % 4;
+                    byte = kind == 0 ? proto::SYNC : kind == 1 ? static_cast<uint8_t>(rng() % 8) : static_cast<uint8_t>(rng());
+                }
+                burst.insert(burst.end(), tail.begin(), tail.end());
+                reference = scan(burst);
+            } while (reference.size() != 1 || !same(reference[0], frame));
+
+            // Every burst ends with its frame, so the decoder starts each one idle.
+            const std::vector<proto::Frame> frames = decode(decoder, burst);
+            expected++;
+            for (const proto::Frame &got : frames)
+                if (same(got, frame)) found++;
+        }
+        CHECK(found == expected);
+        // The noise did make the decoder rescan.
+        CHECK(decoder.crcErrors() > 1000);
+        CHECK(decoder.lengthErrors() > 1000);
+
+        // Plain random bytes, the decoder agrees with the reference scan.
+        std::vector<proto::Frame> reference;
+        for (int round = 0; round < 200; round++) {
+            Bytes bytes(256 + rng() % 256);
+            for (uint8_t &byte : bytes) byte = rng() % 3 ? static_cast<uint8_t>(rng()) : proto::SYNC;
+            for (int i = 0; i < 3; i++) {
+                const Bytes frame = encoded(randomFrame(rng));
+                bytes.insert(bytes.begin() + static_cast<long>(rng() % bytes.size()), frame.begin(), frame.end());
+            }
+
+            proto::Decoder fresh;
+            const std::vector<proto::Frame> frames = decode(fresh, bytes);
+            reference = scan(bytes);
+            CHECK(frames.size() == reference.size());
+            for (size_t i = 0; i < frames.size() && i < reference.size(); i++) CHECK(same(frames[i], reference[i]));
+        }
+    }
+}
+
+int main() {
+    roundTrip();
+    rejectsBadCrc();
+    rejectsBadLength();
+    resyncsInsideFalseFrame();
+    fuzz();
+    return test::result();
+}
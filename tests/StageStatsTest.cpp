@@ -0,0 +1,34 @@
+#include <chrono>
+#include <thread>
+
+#include "pipeline/Pipeline.hpp"
+#include "pipeline/StageStats.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using std::chrono::milliseconds;
+
+    void windowStartsWithPipeline() {
+        pipeline::Pipeline pipeline;
+        pipeline.addStage("work", [](pipeline::Pipeline &p) {
+            p.stats("work").record(milliseconds(20));
+        });
+        const pipeline::StageStats &stats = pipeline.stats("work");
+        CHECK(stats.utilization() == 0.0);
+
+        // Setup before start() doesn't dilute the utilization.
+        std::this_thread::sleep_for(milliseconds(200));
+        pipeline.start();
+        pipeline.join();
+        std::this_thread::sleep_for(milliseconds(20));
+        CHECK(stats.processed() == 1);
+        CHECK(stats.averageMs() == 20.0);
+        CHECK(stats.utilization() > 0.25);
+        CHECK(stats.utilization() <= 1.0);
+    }
+}
+
+int main() {
+    windowStartsWithPipeline();
+    return test::result();
+}
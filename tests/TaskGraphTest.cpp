@@ -0,0 +1,164 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pipeline/TaskGraph.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    // Steps append their names from their own threads.
+    struct Log {
+        std::mutex mutex;
+        std::vector<std::string> names;
+
+        pipeline::TaskGraph::Task step(const std::string &name) {
+            return [this, name] {
+                std::lock_guard lock(mutex);
+                names.push_back(name);
+            };
+        }
+
+        size_t position(const std::string &name) {
+            for (size_t i = 0; i < names.size(); i++)
+                if (names[i] == name) return i;
+            return names.size();
+        }
+    };
+
+    std::string runError(pipeline::TaskGraph &graph) {
+        try {
+            graph.run();
+        }
+        catch (const std::exception &e) {
+            return e.what();
+        }
+        return std::string();
+    }
+
+    void dependencyOrder() {
+        Log log;
+        pipeline::TaskGraph graph;
+        const size_t a = graph.add("a", log.step("a"));
+        const size_t b = graph.add("b", log.step("b"), { a });
+        const size_t c = graph.add("c", log.step("c"), { b });
+        graph.add("d", log.step("d"), { a, c });
+        graph.run();
+
+        CHECK(log.names.size() == 4);
+        CHECK(log.position("a") < log.position("b"));
+        CHECK(log.position("b") < log.position("c"));
+        CHECK(log.position("c") < log.position("d"));
+
+        bool threw = false;
+        try {
+            graph.add("e", log.step("e"), { 10 });
+        }
+        catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+
+    void independentStepsOverlap() {
+        // Each step waits until the other one runs too, which only finishes
+        // if they run at the same time.
+        std::atomic_int running = 0;
+        std::atomic_int met = 0;
+        const auto meet = [&running, &met] {
+            running++;
+            const auto deadline = Clock::now() + milliseconds(2000);
+            while (running.load() < 2 && Clock::now() < deadline) std::this_thread::yield();
+            if (running.load() == 2) met++;
+        };
+        pipeline::TaskGraph graph;
+        graph.add("left", meet);
+        graph.add("right", meet);
+        graph.run();
+        CHECK(met == 2);
+    }
+
+    void failureSkipsDependents() {
+        Log log;
+        pipeline::TaskGraph graph;
+        const size_t broken = graph.add("broken", [] { throw std::runtime_error("broken step"); });
+        const size_t skipped = graph.add("skipped", log.step("skipped"), { broken });
+        graph.add("transitive", log.step("transitive"), { skipped });
+        graph.add("independent", [&log] {
+            std::this_thread::sleep_for(milliseconds(20));
+            log.step("independent")();
+        });
+
+        CHECK(runError(graph) == "broken step");
+        // The independent step still ran to its end.
+        CHECK(log.names.size() == 1);
+        CHECK(log.position("independent") == 0);
+
+        const std::vector<pipeline::TaskGraph::Timing> timings = graph.timings();
+        CHECK(timings.size() == 4);
+        CHECK(timings[0].name == "broken" && !timings[0].done);
+        CHECK(!timings[1].done && timings[1].startMs == 0.0 && timings[1].durationMs == 0.0);
+        CHECK(!timings[2].done && timings[2].startMs == 0.0);
+        CHECK(timings[3].done && timings[3].durationMs >= 20.0);
+    }
+
+    void firstFailureRethrown() {
+        pipeline::TaskGraph graph;
+        graph.add("late", [] {
+            std::this_thread::sleep_for(milliseconds(100));
+            throw std::runtime_error("late");
+        });
+        graph.add("early", [] { throw std::runtime_error("early"); });
+        CHECK(runError(graph) == "early");
+    }
+
+    void timingsOfDoneSteps() {
+        pipeline::TaskGraph graph;
+        const size_t first = graph.add("first", [] { std::this_thread::sleep_for(milliseconds(30)); });
+        graph.add("second", [] {}, { first });
+
+        // Nothing ran yet.
+        for (const pipeline::TaskGraph::Timing &timing : graph.timings()) CHECK(!timing.done);
+        graph.run();
+
+        const std::vector<pipeline::TaskGraph::Timing> timings = graph.timings();
+        CHECK(timings[0].done && timings[1].done);
+        CHECK(timings[0].durationMs >= 30.0);
+        // The dependent step started after the first one finished.
+        CHECK(timings[1].startMs >= timings[0].startMs + timings[0].durationMs);
+    }
+
+    void runsAgain() {
+        std::atomic_int calls = 0;
+        bool fail = true;
+        pipeline::TaskGraph graph;
+        const size_t flaky = graph.add("flaky", [&fail] { if (fail) throw std::runtime_error("flaky"); });
+        graph.add("counted", [&calls] { calls++; }, { flaky });
+
+        CHECK(runError(graph) == "flaky");
+        CHECK(calls == 0);
+        // A second run starts every step over, including the skipped ones.
+        fail = false;
+        CHECK(runError(graph).empty());
+        CHECK(calls == 1);
+        graph.run();
+        CHECK(calls == 2);
+        for (const pipeline::TaskGraph::Timing &timing : graph.timings()) CHECK(timing.done);
+    }
+}
+
+int main() {
+    dependencyOrder();
+    independentStepsOverlap();
+    failureSkipsDependents();
+    firstFailureRethrown();
+    timingsOfDoneSteps();
+    runsAgain();
+    return test::result();
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/Trace.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::microseconds;
+
+    struct Dumped {
+        std::string name;
+        double ts = 0.0;
+        double dur = 0.0;
+        int tid = 0;
+    };
+
+    struct Dump {
+        std::string text;
+        std::vector<Dumped> events;
+    };
+
+    const std::string PATH = (std::filesystem::temp_directory_path() / "gb-trace-test.json").string();
+
+    // Every event is on a line of its own, see writeChromeJson().
+    Dump dump(size_t *count = nullptr) {
+        const size_t written = trace::writeChromeJson(PATH);
+        if (count) *count = written;
+
+        Dump result;
+        std::ifstream in(PATH);
+        std::string line;
+        while (std::getline(in, line)) {
+            result.text += line + '\n';
+            if (line.find("\"ph\":\"X\"") == std::string::npos) continue;
+
+            Dumped event;
+            const size_t nameBegin = line.find("\"name\":\"") + 8;
+            event.name = line.substr(nameBegin, line.find("\",\"ph\"") - nameBegin);
+            std::sscanf(line.c_str() + line.find("\"tid\":"), "\"tid\":%d,\"ts\":%lf,\"dur\":%lf",
+                    &event.tid, &event.ts, &event.dur);
+            result.events.push_back(event);
+        }
+        std::filesystem::remove(PATH);
+        return result;
+    }
+
+    void disabledRecordsNothing() {
+        trace::enable(false);
+        {
+            TRACE_SCOPE("off");
+        }
+        TRACE_BEGIN("off");
+        TRACE_END();
+        size_t count = 1;
+        const Dump result = dump(&count);
+        CHECK(count == 0);
+        CHECK(result.events.empty());
+        CHECK(result.text.find("\"traceEvents\":[") != std::string::npos);
+    }
+
+    void scopesAndNesting() {
+        trace::clear();
+        trace::enable(true);
+        trace::setThreadName("main \"test\"");
+        {
+            TRACE_SCOPE("outer");
+            TRACE_BEGIN("inner");
+            TRACE_END();
+        }
+        // Deeper than 16 is balanced but only the outer 16 are kept.
+        for (int i = 0; i < 20; i++) trace::begin("deep");
+        for (int i = 0; i < 20; i++) trace::end();
+        trace::end();
+        trace::enable(false);
+
+        size_t count = 0;
+        const Dump result = dump(&count);
+        CHECK(count == 2 + 16);
+        CHECK(result.events.size() == count);
+        if (result.events.size() >= 2) {
+            // Inner ends first, outer covers it.
+            CHECK(result.events[0].name == "inner");
+            CHECK(result.events[1].name == "outer");
+            CHECK(result.events[1].ts <= result.events[0].ts);
+            CHECK(result.events[1].ts + result.events[1].dur >= result.events[0].ts + result.events[0].dur);
+        }
+        CHECK(result.text.find("\"args\":{\"name\":\"main \\\"test\\\"\"}") != std::string::npos);
+    }
+
+    void ringKeepsNewest() {
+        trace::clear();
+        const size_t EXTRA = 100;
+        const Clock::time_point base = Clock::now();
+        for (size_t i = 0; i < trace::EVENTS_PER_THREAD + EXTRA; i++)
+            trace::record("tick", base + microseconds(2 * i), base + microseconds(2 * i + 1));
+
+        const Dump result = dump();
+        CHECK(result.events.size() == trace::EVENTS_PER_THREAD);
+        if (result.events.size() == trace::EVENTS_PER_THREAD) {
+            // The first EXTRA events were overwritten, the rest is in order.
+            const double span = result.events.back().ts - result.events.front().ts;
+            CHECK(std::abs(span - 2.0 * (trace::EVENTS_PER_THREAD - 1)) < 0.01);
+            bool ordered = true;
+            for (size_t i = 1; i < result.events.size(); i++)
+                ordered = ordered && std::abs(result.events[i].ts - result.events[i - 1].ts - 2.0) < 0.01;
+            CHECK(ordered);
+            CHECK(std::abs(result.events.front().dur - 1.0) < 0.01);
+        }
+
+        trace::clear();
+        CHECK(dump().events.empty());
+    }
+
+    void dumpWhileRecording() {
+        trace::clear();
+        trace::enable(true);
+        std::atomic_bool stop = false;
+        std::thread writer([&stop] {
+            trace::setThreadName("writer");
+            while (!stop.load()) {
+                TRACE_SCOPE("busy");
+                std::this_thread::yield();
+            }
+        });
+
+        // Slots overwritten while copied are dropped, whatever is dumped is whole.
+        bool wellFormed = true;
+        size_t seen = 0;
+        for (int i = 0; i < 20; i++) {
+            const Dump result = dump();
+            seen += result.events.size();
+            for (const Dumped &event : result.events)
+                wellFormed = wellFormed && event.name == "busy" && event.dur >= 0.0;
+            wellFormed = wellFormed && result.events.size() <= trace::EVENTS_PER_THREAD;
+            std::this_thread::yield();
+        }
+        stop = true;
+        writer.join();
+        trace::enable(false);
+        CHECK(wellFormed);
+        CHECK(seen > 0);
+
+        // The thread is gone, its events and name are not.
+        const Dump after = dump();
+        CHECK(!after.events.empty());
+        CHECK(after.text.find("\"args\":{\"name\":\"writer\"}") != std::string::npos);
+    }
+}
+
+int main() {
+    disabledRecordsNothing();
+    scopesAndNesting();
+    ringKeepsNewest();
+    dumpWhileRecording();
+    return test::result();
+}
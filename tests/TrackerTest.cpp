@@ -0,0 +1,139 @@
+#include <cmath>
+
+#include "detect/Tracker.hpp"
+#include "tests/Check.hpp"
+
+namespace {
+    detect::Detections at(int x, int y, int size = 100, float confidence = 0.9f) {
+        return { { cv::Rect(x, y, size, size), confidence } };
+    }
+
+    bool near(float a, float b, float tolerance = 0.01f) {
+        return std::fabs(a - b) <= tolerance;
+    }
+
+    // A box detected on every frame while moving 4 px to the right.
+    detect::Tracker movingRight(const detect::Tracker::Params &params, int frames) {
+        detect::Tracker tracker(params);
+        for (int i = 0; i < frames; i++) tracker.update(at(100 + 4 * i, 50));
+        return tracker;
+    }
+
+    void matchesAndCreates() {
+        detect::Tracker tracker;
+        tracker.update(at(100, 100));
+        CHECK(tracker.tracks().size() == 1);
+        const int id = tracker.tracks()[0].id;
+
+        // Overlapping box keeps the track, a far one starts a new one.
+        detect::Detections detections = at(110, 105);
+        detections.push_back({ cv::Rect(400, 100, 80, 80), 0.8f });
+        tracker.update(detections);
+        CHECK(tracker.tracks().size() == 2);
+        CHECK(tracker.tracks()[0].id == id);
+        CHECK(tracker.tracks()[0].rect() == cv::Rect(110, 105, 100, 100));
+        CHECK(tracker.tracks()[1].id != id);
+        CHECK(!tracker.needsDetection());
+
+        // The largest box is the primary unless another one is followed.
+        CHECK(tracker.primary()->id == id);
+        CHECK(tracker.primary(tracker.tracks()[1].id)->id == tracker.tracks()[1].id);
+        CHECK(tracker.primary(12345)->id == id);
+    }
+
+    void dropsAfterMissedDetections() {
+        detect::Tracker::Params params;
+        params.maxMisses = 2;
+        detect::Tracker tracker(params);
+        tracker.update(at(100, 100));
+        for (int i = 0; i < params.maxMisses; i++) tracker.update({});
+        CHECK(tracker.tracks().size() == 1);
+        tracker.update({});
+        CHECK(tracker.tracks().empty());
+        CHECK(tracker.primary() == nullptr);
+    }
+
+    void extrapolatesThenHolds() {
+        detect::Tracker::Params params;
+        params.velocityGain = 1.0f;
+        params.maxExtrapolated = 5;
+        detect::Tracker tracker = movingRight(params, 3);
+        CHECK(near(tracker.tracks()[0].velocity.x, 4.0f));
+
+        for (int i = 0; i < 20; i++) tracker.predict();
+        const detect::Track &track = tracker.tracks()[0];
+        // Moved for maxExtrapolated frames only, from x = 108.
+        CHECK(near(track.box.x, 108.0f + 5 * 4.0f));
+        CHECK(near(track.box.y, 50.0f));
+        CHECK(track.framesSinceMatch == 20);
+    }
+
+    void expiresWithoutDetections() {
+        detect::Tracker::Params params;
+        params.maxUnmatchedFrames = 10;
+        detect::Tracker tracker;
+        detect::Tracker bounded(params);
+        tracker.update(at(100, 100));
+        bounded.update(at(100, 100));
+        for (int i = 0; i < params.maxUnmatchedFrames; i++) bounded.predict();
+        CHECK(bounded.tracks().size() == 1);
+        bounded.predict();
+        CHECK(bounded.tracks().empty());
+
+        // The default bound ends a track predicted for long as well.
+        for (int i = 0; i < 1000; i++) tracker.predict();
+        CHECK(tracker.tracks().empty());
+    }
+
+    void velocityAfterHold() {
+        // Seen again 10 frames later, 40 px further, after the prediction held
+        // still for half of them. The velocity stays at the true 4 px.
+        detect::Tracker::Params params;
+        params.velocityGain = 1.0f;
+        params.maxExtrapolated = 5;
+        detect::Tracker tracker = movingRight(params, 3);
+        for (int i = 0; i < 9; i++) tracker.predict();
+        tracker.update(at(108 + 10 * 4, 50));
+        CHECK(tracker.tracks().size() == 1);
+        CHECK(near(tracker.tracks()[0].velocity.x, 4.0f));
+        CHECK(tracker.tracks()[0].framesSinceMatch == 0);
+    }
+
+    void needsDetectionWhenUnreliable() {
+        detect::Tracker::Params params;
+        params.maxExtrapolated = 5;
+        params.confidenceDecay = 0.9f;
+        params.minConfidence = 0.5f;
+
+        // A still box stays trusted until its confidence decayed.
+        detect::Tracker still(params);
+        still.update(at(100, 100, 100, 0.9f));
+        still.update(at(100, 100, 100, 0.9f));
+        for (int i = 0; i < 5; i++) still.predict();
+        CHECK(!still.needsDetection());
+        // 0.9 * 0.9^n < 0.5 from n = 6 on.
+        still.predict();
+        CHECK(still.needsDetection());
+
+        // A moving box is due once its prediction stopped following it.
+        detect::Tracker moving = movingRight(params, 3);
+        for (int i = 0; i < 4; i++) moving.predict();
+        CHECK(!moving.needsDetection());
+        moving.predict();
+        CHECK(moving.needsDetection());
+
+        // A match makes the track reliable again.
+        moving.update(at(moving.tracks()[0].rect().x, 50));
+        CHECK(!moving.needsDetection());
+    }
+}
+
+int main() {
+    matchesAndCreates();
+    dropsAfterMissedDetections();
+    extrapolatesThenHolds();
+    expiresWithoutDetections();
+    velocityAfterHold();
+    needsDetectionWhenUnreliable();
+    return test::result();
+}
@@ -0,0 +1,227 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace trace {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // Fields are atomics because a dump may read a slot while its thread
+        // overwrites it, such slots are recognized and skipped afterwards.
+        struct Event {
+            std::atomic<const char *> name = nullptr;
+            std::atomic_int64_t beginNs = 0;
+            std::atomic_int64_t endNs = 0;
+        };
+
+        struct ThreadBuffer {
+            explicit ThreadBuffer(uint32_t id) : id(id), events(std::make_unique<Event[]>(EVENTS_PER_THREAD)) {}
+
+            const uint32_t id;
+            // Guarded by the registry mutex.
+            std::string name;
+            const std::unique_ptr<Event[]> events;
+            // Events started and finished being written, free running.
+            std::atomic_uint64_t claimed = 0;
+            std::atomic_uint64_t written = 0;
+            // Events before this one were cleared.
+            std::atomic_uint64_t firstKept = 0;
+        };
+
+        struct Registry {
+            std::atomic_bool enabled = false;
+            // Timestamps in the file count from here.
+            const Clock::time_point origin = Clock::now();
+            std::mutex mutex;
+            // Buffers of finished threads are kept, their events are still wanted.
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        };
+
+        Registry &registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        struct OpenEvent {
+            const char *name;
+            Clock::time_point begin;
+        };
+
+        struct ThreadState {
+            std::shared_ptr<ThreadBuffer> buffer;
+            std::string name;
+            std::array<OpenEvent, 16> open;
+            size_t depth = 0;
+        };
+
+        thread_local ThreadState threadState;
+
+        ThreadBuffer &threadBuffer() {
+            if (!threadState.buffer) {
+                Registry &reg = registry();
+                std::lock_guard lock(reg.mutex);
+                threadState.buffer = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(reg.buffers.size() + 1));
+                threadState.buffer->name = threadState.name;
+                reg.buffers.push_back(threadState.buffer);
+            }
+
+            return *threadState.buffer;
+        }
+
+        void writeEscaped(std::ostream &out, const char *text) {
+            for (const char *c = text; *c; c++) {
+                switch (*c) {
+                    case '"': out << "\\\""; break;
+                    case '\\': out << "\\\\"; break;
+                    case '\n': out << "\\n"; break;
+                    case '\t': out << "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(*c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+                            out << escaped;
+                        }
+                        else out << *c;
+                }
+            }
+        }
+    }
+
+    void enable(bool enabled) {
+        registry().enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() {
+        return registry().enabled.load(std::memory_order_relaxed);
+    }
+
+    void setThreadName(const std::string &name) {
+        threadState.name = name;
+        if (threadState.buffer) {
+            std::lock_guard lock(registry().mutex);
+            threadState.buffer->name = name;
+        }
+    }
+
+    void record(const char *name, Clock::time_point begin, Clock::time_point end) {
+        ThreadBuffer &buffer = threadBuffer();
+        const Clock::time_point origin = registry().origin;
+
+        const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+        buffer.claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Event &event = buffer.events[index % EVENTS_PER_THREAD];
+        event.name.store(name, std::memory_order_relaxed);
+        event.beginNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count(),
+                std::memory_order_relaxed);
+        event.endNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - origin).count(),
+                std::memory_order_relaxed);
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+
+    void begin(const char *name) {
+        // Deeper events are dropped but still have to be balanced.
+        if (threadState.depth < threadState.open.size())
+            threadState.open[threadState.depth] = { name, isEnabled() ? Clock::now() : Clock::time_point() };
+        threadState.depth++;
+    }
+
+    void end() {
+        if (threadState.depth == 0) return;
+
+        threadState.depth--;
+        if (threadState.depth >= threadState.open.size()) return;
+        const OpenEvent &open = threadState.open[threadState.depth];
+        if (open.begin != Clock::time_point()) record(open.name, open.begin, Clock::now());
+    }
+
+    size_t writeChromeJson(const std::string &path) {
+        struct Copied {
+            const char *name;
+            int64_t beginNs;
+            int64_t endNs;
+        };
+        struct Thread {
+            uint32_t id;
+            std::string name;
+            std::vector<Copied> events;
+        };
+
+        std::vector<Thread> threads;
+        {
+            Registry &reg = registry();
+            std::lock_guard lock(reg.mutex);
+            for (const std::shared_ptr<ThreadBuffer> &buffer : reg.buffers)
+                threads.push_back({ buffer->id, buffer->name, {} });
+
+            for (size_t t = 0; t < threads.size(); t++) {
+                const ThreadBuffer &buffer = *reg.buffers[t];
+                const uint64_t written = buffer.written.load(std::memory_order_acquire);
+                uint64_t first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+                first = std::max(first, buffer.firstKept.load(std::memory_order_relaxed));
+
+                std::vector<Copied> &events = threads[t].events;
+                for (uint64_t i = first; i < written; i++) {
+                    const Event &event = buffer.events[i % EVENTS_PER_THREAD];
+                    events.push_back({ event.name.load(std::memory_order_relaxed),
+                            event.beginNs.load(std::memory_order_relaxed), event.endNs.load(std::memory_order_relaxed) });
+                }
+
+                // Slots the thread started to overwrite while they were copied are dropped.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const uint64_t claimed = buffer.claimed.load(std::memory_order_relaxed);
+                const uint64_t firstValid = claimed > EVENTS_PER_THREAD ? claimed - EVENTS_PER_THREAD : 0;
+                if (firstValid > first)
+                    events.erase(events.begin(), events.begin() + static_cast<ptrdiff_t>(std::min(firstValid - first,
+                            static_cast<uint64_t>(events.size()))));
+            }
+        }
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) throw std::runtime_error("Could not open '" + path + "' to write the trace.");
+
+        size_t count = 0;
+        char number[64];
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const Thread &thread : threads) {
+            if (!thread.name.empty()) {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                        << thread.id << ",\"args\":{\"name\":\"";
+                writeEscaped(out, thread.name.c_str());
+                out << "\"}}";
+                first = false;
+            }
+            for (const Copied &event : thread.events) {
+                if (!event.name) continue;
+                // Microseconds, nanosecond precision is kept in the fraction.
+                std::snprintf(number, sizeof(number), "\"ts\":%.3f,\"dur\":%.3f", event.beginNs / 1000.0,
+                        (event.endNs - event.beginNs) / 1000.0);
+                out << (first ? "" : ",") << "\n{\"name\":\"";
+                writeEscaped(out, event.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id << "," << number << "}";
+                first = false;
+                count++;
+            }
+        }
+        out << "\n]}\n";
+        if (!out) throw std::runtime_error("Could not write the trace to '" + path + "'.");
+
+        return count;
+    }
+
+    void clear() {
+        Registry &reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (const std::shared_ptr<ThreadBuffer> &buffer : reg.buffers)
+            buffer->firstKept.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
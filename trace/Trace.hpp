@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef PROFILING
+#define BUILD_WITH_EASY_PROFILER
+#include <easy/profiler.h>
+#endif
+
+namespace trace {
+    // Tracing is compiled in everywhere and off until enabled. While off, a
+    // scope costs one relaxed load. While on, every thread writes complete
+    // events into its own ring of the last EVENTS_PER_THREAD events, without
+    // locks, and writeChromeJson() saves them for chrome://tracing or Perfetto.
+    const size_t EVENTS_PER_THREAD = 16384u;
+
+    void enable(bool enabled);
+    bool isEnabled();
+
+    // Shown instead of the thread id in the trace.
+    void setThreadName(const std::string &name);
+
+    // name must outlive the trace, a string literal in practice.
+    void record(const char *name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end);
+    // Non-scoped events of the calling thread, they nest up to 16 deep.
+    void begin(const char *name);
+    void end();
+
+    // Writes the events of all threads, finished ones included. Recording may
+    // go on meanwhile. Returns the number of events, throws if the file can't
+    // be written.
+    size_t writeChromeJson(const std::string &path);
+    // Forgets everything recorded so far.
+    void clear();
+
+    class Scope {
+    public:
+        explicit Scope(const char *name)
+            : name_(name), begin_(isEnabled() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+        ~Scope() {
+            if (begin_ != std::chrono::steady_clock::time_point())
+                record(name_, begin_, std::chrono::steady_clock::now());
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name_;
+        const std::chrono::steady_clock::time_point begin_;
+    };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// Builds with GB_PROFILER_MODE also hand the blocks to easy_profiler.
+#ifdef PROFILING
+#define TRACE_SCOPE(name) EASY_BLOCK(name); const ::trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_BEGIN(name) EASY_NONSCOPED_BLOCK(name); ::trace::begin(name)
+#define TRACE_END() EASY_END_BLOCK; ::trace::end()
+#else
+#define TRACE_SCOPE(name) const ::trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_BEGIN(name) ::trace::begin(name)
+#define TRACE_END() ::trace::end()
+#endif
@@ -1,24 +1,56 @@
 #include "CVCameraAdapter.hpp"
 
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
 namespace vidIO {
-    CVCameraAdapter::CVCameraAdapter() {
-        this->open();
+    namespace {
+        // A device timestamp further back than this is taken for something else.
+        const std::chrono::seconds MAX_DEVICE_AGE(1);
+    }
+
+    CVCameraAdapter::CVCameraAdapter(int deviceIndex) : deviceIndex_(deviceIndex) {
+        if (!this->open())
+            throw std::runtime_error("Could not open camera " + std::to_string(deviceIndex_) + ".");
         this->fdat.width = cap_.get(cv::CAP_PROP_FRAME_WIDTH);
         this->fdat.height = cap_.get(cv::CAP_PROP_FRAME_HEIGHT);
     }
 
     bool CVCameraAdapter::open() {
-        return cap_.open(0);
+        // Reopening a device is slow and some drivers reset it, so don't.
+        return cap_.isOpened() || cap_.open(deviceIndex_);
     }
 
     void CVCameraAdapter::close() { if (cap_.isOpened()) cap_.release(); }
     Frame CVCameraAdapter::nextFrame() {
         cv::Mat frame;
-        if (!cap_.read(frame))
-            throw std::runtime_error("Device could not read frame.");
+        this->nextFrame(frame);
 
         return frame;
     }
+    void CVCameraAdapter::nextFrame(Frame &dst) {
+        // Grabbing and decoding separately tells when the frame arrived.
+        this->grab();
+        if (!cap_.retrieve(dst))
+            throw std::runtime_error("Device could not read frame.");
+    }
+
+    void CVCameraAdapter::grab() {
+        if (!cap_.grab())
+            throw std::runtime_error("Device could not read frame.");
+
+        using namespace std::chrono;
+        grabbed_ = steady_clock::now();
+#ifdef __linux__
+        // V4L2 reports when the driver filled the buffer on CLOCK_MONOTONIC,
+        // the clock steady_clock reads. Other backends report a stream
+        // position instead, so only a time shortly before now is taken.
+        const double ms = cap_.get(cv::CAP_PROP_POS_MSEC);
+        const steady_clock::time_point device(duration_cast<steady_clock::duration>(duration<double, std::milli>(ms)));
+        if (ms > 0.0 && device <= grabbed_ && grabbed_ - device < MAX_DEVICE_AGE) grabbed_ = device;
+#endif
+    }
 
     CVCameraAdapter::~CVCameraAdapter() { this->close(); }
 }
\ No newline at end of file
@@ -8,13 +8,17 @@
 namespace vidIO {
     class CVCameraAdapter : public CameraAdapter {
     public:
-        CVCameraAdapter();
+        explicit CVCameraAdapter(int deviceIndex = 0);
         ~CVCameraAdapter();
         bool open() override;
         void close() override;
         Frame nextFrame() override;
+        void nextFrame(Frame &dst) override;
 
     private:
+        void grab();
+
         cv::VideoCapture cap_;
+        int deviceIndex_;
     };
 }
\ No newline at end of file
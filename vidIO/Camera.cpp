@@ -1,15 +1,16 @@
 #include "Camera.hpp"
 
 namespace vidIO {
-    Camera::Camera() {
-        adapter = std::make_unique<CVCameraAdapter>();
-        adapter->open();
-    }
+    // The adapter opens the device in its constructor already.
+    Camera::Camera() : adapter(std::make_unique<CVCameraAdapter>()) {}
+    Camera::Camera(std::unique_ptr<CameraAdapter> source) : adapter(std::move(source)) {}
     Frame Camera::nextFrame() { return adapter->nextFrame(); }
+    void Camera::nextFrame(Frame &dst) { adapter->nextFrame(dst); }
     bool Camera::open() { return adapter->open(); }
     void Camera::close() { adapter->close(); }
     Camera::~Camera() { adapter->close(); }
     auto Camera::frameData() const -> const FrameData & {
         return adapter->frameData();
     }
+    std::chrono::steady_clock::time_point Camera::grabbed() const { return adapter->grabbed(); }
 }
\ No newline at end of file
@@ -8,11 +8,14 @@ namespace vidIO {
     class Camera {
     public:
         Camera();
+        explicit Camera(std::unique_ptr<CameraAdapter> source);
         ~Camera();
         bool open();
         void close();
         Frame nextFrame();
+        void nextFrame(Frame &dst);
         auto frameData() const -> const FrameData &;
+        std::chrono::steady_clock::time_point grabbed() const;
     private:
         std::unique_ptr<CameraAdapter> adapter = nullptr;
     };
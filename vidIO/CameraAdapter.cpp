@@ -3,3 +3,9 @@
 auto vidIO::CameraAdapter::frameData() const -> const FrameData & {
     return fdat;
 }
+
+void vidIO::CameraAdapter::nextFrame(Frame &dst) {
+    const Frame frame = this->nextFrame();
+    grabbed_ = std::chrono::steady_clock::now();
+    frame.copyTo(dst);
+}
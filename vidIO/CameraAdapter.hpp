@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include <opencv2/imgproc.hpp>
 
 namespace vidIO {
@@ -14,8 +16,14 @@ namespace vidIO {
         virtual bool open() = 0;
         virtual void close() = 0;
         virtual Frame nextFrame() = 0;
+        // Reads next frame into already allocated storage, adapters override it
+        // when they are able to decode in place.
+        virtual void nextFrame(Frame &dst);
         auto frameData() const -> const FrameData &;
+        // When the device handed over the frame read last, before decoding it.
+        std::chrono::steady_clock::time_point grabbed() const { return grabbed_; }
     protected:
         FrameData fdat;
+        std::chrono::steady_clock::time_point grabbed_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "CameraGroup.hpp"
+
+namespace vidIO {
+    size_t CameraGroup::add(std::unique_ptr<CameraAdapter> adapter) {
+        Stream stream;
+        stream.camera = std::make_unique<Camera>(std::move(adapter));
+        stream.ring = std::make_unique<FrameRing>(stream.camera->frameData(), CV_8UC3, 4u, streams_.size());
+        streams_.push_back(std::move(stream));
+
+        return streams_.size() - 1;
+    }
+
+    std::optional<FrameMeta> CameraGroup::captureNext(size_t streamId, std::chrono::steady_clock::time_point *delivered) {
+        Stream &stream = streams_.at(streamId);
+        Frame *slot = stream.ring->beginWrite();
+        if (!slot) {
+            // Every slot is held by readers, skip the frame but keep the device drained.
+            stream.camera->nextFrame();
+            if (delivered) *delivered = stream.camera->grabbed();
+            return std::nullopt;
+        }
+
+        FrameMeta meta;
+        try {
+            stream.camera->nextFrame(*slot);
+            if (delivered) *delivered = stream.camera->grabbed();
+            meta = stream.ring->commitWrite(stream.camera->grabbed());
+        }
+        catch (...) {
+            stream.ring->abortWrite();
+            throw;
+        }
+
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+
+        return meta;
+    }
+
+    void CameraGroup::waitForFrames(uint32_t seenEpoch) const {
+        if (this->isClosed()) return;
+
+        epoch_.wait(seenEpoch, std::memory_order_acquire);
+    }
+
+    void CameraGroup::close() {
+        closed_.store(true, std::memory_order_release);
+        for (Stream &stream : streams_) stream.ring->close();
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+    }
+}
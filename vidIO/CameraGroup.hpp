@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "Camera.hpp"
+#include "FrameRing.hpp"
+
+namespace vidIO {
+    // Set of cameras captured side by side. Every stream owns a camera and a
+    // frame ring, its index in the group is the stream id. captureNext() is
+    // meant to be called in a loop from a thread dedicated to the stream,
+    // consumers interested in any stream sleep in waitForFrames().
+    class CameraGroup {
+    public:
+        CameraGroup() = default;
+        CameraGroup(const CameraGroup &) = delete;
+        CameraGroup &operator=(const CameraGroup &) = delete;
+
+        // Must be called before capturing starts. Returns stream id.
+        size_t add(std::unique_ptr<CameraAdapter> adapter);
+
+        size_t size() const { return streams_.size(); }
+        Camera &camera(size_t streamId) { return *streams_.at(streamId).camera; }
+        FrameRing &ring(size_t streamId) { return *streams_.at(streamId).ring; }
+
+        // Reads one frame of the stream into its ring, throws what the adapter throws.
+        // Returns the metadata of the published frame, nothing if it was dropped.
+        // delivered, if given, is set to when the camera handed the frame over,
+        // before decoding, so the time spent decoding and committing it can be
+        // told from waiting for it.
+        std::optional<FrameMeta> captureNext(size_t streamId,
+                std::chrono::steady_clock::time_point *delivered = nullptr);
+
+        uint32_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+        // Sleeps until any stream publishes a frame after seenEpoch was taken.
+        void waitForFrames(uint32_t seenEpoch) const;
+        void close();
+        bool isClosed() const { return closed_.load(std::memory_order_acquire); }
+
+    private:
+        struct Stream {
+            std::unique_ptr<Camera> camera;
+            std::unique_ptr<FrameRing> ring;
+        };
+
+        std::vector<Stream> streams_;
+        std::atomic_uint32_t epoch_ = 0;
+        std::atomic_bool closed_ = false;
+    };
+}
@@ -0,0 +1,123 @@
+#include "FileCameraAdapter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <thread>
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace vidIO {
+    namespace {
+        const double DEFAULT_FPS = 30.0;
+
+        bool isImageFile(const std::filesystem::path &p) {
+            std::string ext = p.extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(),
+                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+            return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp";
+        }
+    }
+
+    FileCameraAdapter::FileCameraAdapter(const std::filesystem::path &source, Pacing pacing,
+            bool shouldLoop, double fps)
+        : source_(source), pacing_(pacing), shouldLoop_(shouldLoop), fps_(fps) {
+        if (!this->open())
+            throw std::runtime_error("Could not open '" + source_.string() + "' as a frame source.");
+    }
+
+    bool FileCameraAdapter::open() {
+        this->close();
+        namespace fs = std::filesystem;
+        if (fs::is_directory(source_)) {
+            for (const auto &entry : fs::directory_iterator(source_))
+                if (entry.is_regular_file() && isImageFile(entry.path()))
+                    images_.push_back(entry.path());
+            std::sort(images_.begin(), images_.end());
+            if (images_.empty()) return false;
+
+            const cv::Mat first = cv::imread(images_.front().string(), cv::IMREAD_COLOR);
+            if (first.empty()) return false;
+            this->fdat.width = first.cols;
+            this->fdat.height = first.rows;
+        }
+        else {
+            if (!cap_.open(source_.string())) return false;
+            this->fdat.width = cap_.get(cv::CAP_PROP_FRAME_WIDTH);
+            this->fdat.height = cap_.get(cv::CAP_PROP_FRAME_HEIGHT);
+            if (fps_ <= 0.0) fps_ = cap_.get(cv::CAP_PROP_FPS);
+        }
+        if (fps_ <= 0.0) fps_ = DEFAULT_FPS;
+
+        started_ = std::chrono::steady_clock::now();
+        framesServed_ = 0;
+
+        return true;
+    }
+
+    void FileCameraAdapter::close() {
+        if (cap_.isOpened()) cap_.release();
+        images_.clear();
+        nextImage_ = 0;
+    }
+
+    Frame FileCameraAdapter::nextFrame() {
+        Frame frame;
+        this->nextFrame(frame);
+
+        return frame;
+    }
+
+    void FileCameraAdapter::nextFrame(Frame &dst) {
+        if (!this->readNext(dst)) {
+            if (!shouldLoop_) throw EndOfStream();
+
+            this->rewind();
+            if (!this->readNext(dst))
+                throw std::runtime_error("Could not read frame from '" + source_.string() + "'.");
+        }
+        this->waitForDeadline();
+        // A replayed frame arrives when its deadline came, like from a camera.
+        grabbed_ = std::chrono::steady_clock::now();
+        framesServed_++;
+    }
+
+    void FileCameraAdapter::rewind() {
+        if (cap_.isOpened()) cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
+        nextImage_ = 0;
+    }
+
+    bool FileCameraAdapter::readNext(Frame &dst) {
+        if (cap_.isOpened()) return cap_.read(dst);
+
+        while (nextImage_ < images_.size()) {
+            const cv::Mat image = cv::imread(images_[nextImage_++].string(), cv::IMREAD_COLOR);
+            if (image.empty()) continue;
+
+            // Every frame gets the size of the first one, so a stray image of
+            // another size doesn't reallocate the ring slot it is written to.
+            const cv::Size size(static_cast<int>(this->fdat.width), static_cast<int>(this->fdat.height));
+            if (image.cols != size.width || image.rows != size.height) {
+                const bool shrinking = image.cols > size.width || image.rows > size.height;
+                cv::resize(image, dst, size, 0.0, 0.0, shrinking ? cv::INTER_AREA : cv::INTER_LINEAR);
+                return true;
+            }
+            // Copying into dst keeps preallocated frame storage in use.
+            image.copyTo(dst);
+            return true;
+        }
+
+        return false;
+    }
+
+    void FileCameraAdapter::waitForDeadline() {
+        if (pacing_ != Pacing::RealTime) return;
+
+        // Deadlines are counted from the start so sleep jitter does not accumulate.
+        const auto deadline = started_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(framesServed_ / fps_));
+        std::this_thread::sleep_until(deadline);
+    }
+
+    FileCameraAdapter::~FileCameraAdapter() { this->close(); }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "CameraAdapter.hpp"
+
+namespace vidIO {
+    enum class Pacing {
+        // Frames are handed out as soon as they are decoded
+        AsFastAsPossible,
+        // Frames are handed out at the recorded (or given) frame rate
+        RealTime
+    };
+
+    // Thrown by adapters with finite input once every frame has been read.
+    class EndOfStream : public std::runtime_error {
+    public:
+        EndOfStream() : std::runtime_error("End of stream reached.") {}
+    };
+
+    // Replays a video file or a directory of images as if it was a camera,
+    // used to run the pipeline on recorded footage without a device. Images
+    // are scaled to the size of the first one.
+    class FileCameraAdapter : public CameraAdapter {
+    public:
+        FileCameraAdapter(const std::filesystem::path &source, Pacing pacing = Pacing::RealTime,
+                bool shouldLoop = false, double fps = 0.0);
+        ~FileCameraAdapter();
+        bool open() override;
+        void close() override;
+        Frame nextFrame() override;
+        void nextFrame(Frame &dst) override;
+
+    private:
+        void rewind();
+        bool readNext(Frame &dst);
+        void waitForDeadline();
+
+        std::filesystem::path source_;
+        Pacing pacing_;
+        bool shouldLoop_;
+        double fps_;
+
+        cv::VideoCapture cap_;
+        std::vector<std::filesystem::path> images_;
+        size_t nextImage_ = 0;
+
+        std::chrono::steady_clock::time_point started_;
+        uint64_t framesServed_ = 0;
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace vidIO {
+    // Travels with every frame and with everything derived from it, so any
+    // stage can tell which frame it works on and how old it is.
+    struct FrameMeta {
+        // Per stream, starts at 1, 0 means no frame.
+        uint64_t sequence = 0;
+        size_t streamId = 0;
+        // When the camera handed the frame over, before it was decoded.
+        std::chrono::steady_clock::time_point captured;
+    };
+}
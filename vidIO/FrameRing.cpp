@@ -0,0 +1,156 @@
+#include "FrameRing.hpp"
+
+#include <stdexcept>
+
+namespace vidIO {
+    FrameRing::FrameRing(const FrameData &fdat, int type, size_t slotsCount, size_t streamId)
+        : slots_(std::make_unique<Slot[]>(slotsCount)), slotsCount_(slotsCount), streamId_(streamId),
+          latest_(slotsCount), writing_(slotsCount) {
+        if (slotsCount < 2u)
+            throw std::invalid_argument("Frame ring needs at least two slots.");
+
+        for (size_t i = 0; i < slotsCount_; i++)
+            slots_[i].frame.create(static_cast<int>(fdat.height), static_cast<int>(fdat.width), type);
+    }
+
+    Frame *FrameRing::beginWrite() {
+        const size_t latest = latest_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slotsCount_; i++) {
+            const size_t candidate = (cursor_ + i) % slotsCount_;
+            if (candidate == latest) continue;
+
+            int expected = 0;
+            if (slots_[candidate].state.compare_exchange_strong(expected, -1, std::memory_order_acquire)) {
+                writing_ = candidate;
+                cursor_ = (candidate + 1) % slotsCount_;
+                return &slots_[candidate].frame;
+            }
+        }
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+
+        return nullptr;
+    }
+
+    FrameMeta FrameRing::commitWrite() {
+        return this->commitWrite(std::chrono::steady_clock::now());
+    }
+
+    FrameMeta FrameRing::commitWrite(std::chrono::steady_clock::time_point captured) {
+        if (writing_ == slotsCount_) return FrameMeta();
+
+        Slot &slot = slots_[writing_];
+        slot.meta.sequence = published_.load(std::memory_order_relaxed) + 1;
+        slot.meta.streamId = streamId_;
+        slot.meta.captured = captured;
+        const FrameMeta meta = slot.meta;
+        slot.state.store(0, std::memory_order_release);
+        latest_.store(writing_, std::memory_order_release);
+        published_.store(meta.sequence, std::memory_order_release);
+        writing_ = slotsCount_;
+
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+
+        return meta;
+    }
+
+    void FrameRing::abortWrite() {
+        if (writing_ == slotsCount_) return;
+
+        slots_[writing_].state.store(0, std::memory_order_release);
+        writing_ = slotsCount_;
+    }
+
+    bool FrameRing::push(const Frame &frame) {
+        Frame *slot = this->beginWrite();
+        if (!slot) return false;
+
+        frame.copyTo(*slot);
+        this->commitWrite();
+
+        return true;
+    }
+
+    FrameRing::Lease FrameRing::acquireLatest() {
+        for (;;) {
+            const size_t latest = latest_.load(std::memory_order_acquire);
+            if (latest == slotsCount_) return Lease();
+
+            Slot &slot = slots_[latest];
+            int readers = slot.state.load(std::memory_order_relaxed);
+            while (readers >= 0) {
+                if (!slot.state.compare_exchange_weak(readers, readers + 1, std::memory_order_acquire)) continue;
+                // Between reading the index and pinning the slot the producer
+                // may have published elsewhere, then rewritten or aborted this
+                // one. Only a slot which is still the latest holds that frame.
+                if (latest_.load(std::memory_order_acquire) == latest) return Lease(&slot);
+
+                slot.state.fetch_sub(1, std::memory_order_release);
+                break;
+            }
+            // The producer has claimed this slot after publishing a newer one,
+            // so the latest index is already different.
+        }
+    }
+
+    void FrameRing::close() {
+        closed_.store(true, std::memory_order_release);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+    }
+
+    FrameRing::Lease::Lease(Lease &&other) noexcept : slot_(other.slot_) {
+        other.slot_ = nullptr;
+    }
+
+    FrameRing::Lease &FrameRing::Lease::operator=(Lease &&other) noexcept {
+        if (this != &other) {
+            this->release();
+            slot_ = other.slot_;
+            other.slot_ = nullptr;
+        }
+
+        return *this;
+    }
+
+    FrameRing::Lease::~Lease() { this->release(); }
+
+    void FrameRing::Lease::release() {
+        if (slot_) {
+            slot_->state.fetch_sub(1, std::memory_order_release);
+            slot_ = nullptr;
+        }
+    }
+
+    FrameRing::Lease FrameRing::Consumer::acquireLatest() {
+        Lease lease = ring_.acquireLatest();
+        if (!lease || lease.sequence() <= last_) return Lease();
+
+        if (last_ != 0 && lease.sequence() > last_ + 1)
+            dropped_.fetch_add(lease.sequence() - last_ - 1, std::memory_order_relaxed);
+        last_ = lease.sequence();
+
+        return lease;
+    }
+
+    FrameRing::Lease FrameRing::Consumer::waitLatest() {
+        for (;;) {
+            const uint32_t epoch = ring_.epoch_.load(std::memory_order_acquire);
+            if (ring_.isClosed()) return Lease();
+
+            Lease lease = this->acquireLatest();
+            if (lease) return lease;
+
+            ring_.epoch_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+    bool FrameRing::Consumer::readLatest(Frame &dst) {
+        const Lease lease = this->acquireLatest();
+        if (!lease) return false;
+
+        lease.frame().copyTo(dst);
+
+        return true;
+    }
+}
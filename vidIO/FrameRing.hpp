@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+#include "CameraAdapter.hpp"
+#include "FrameMeta.hpp"
+
+namespace vidIO {
+    // Bounded single-producer/multi-consumer frame storage.
+    // All slots are allocated once in the constructor and reused afterwards, so
+    // capturing does not allocate per frame. The producer never waits for readers:
+    // when every slot is busy the incoming frame is dropped and counted.
+    class FrameRing {
+        struct Slot {
+            Frame frame;
+            // Stamped when the producer published the frame.
+            FrameMeta meta;
+            // -1 while the producer writes into the slot, otherwise the number of
+            // readers currently holding it.
+            std::atomic_int state = 0;
+        };
+    public:
+        // Read access to one published slot. The slot can not be overwritten
+        // while the lease is alive.
+        class Lease {
+        public:
+            Lease() = default;
+            Lease(Lease &&other) noexcept;
+            Lease &operator=(Lease &&other) noexcept;
+            Lease(const Lease &) = delete;
+            Lease &operator=(const Lease &) = delete;
+            ~Lease();
+
+            explicit operator bool() const { return slot_ != nullptr; }
+            const Frame &frame() const { return slot_->frame; }
+            const FrameMeta &meta() const { return slot_->meta; }
+            uint64_t sequence() const { return slot_->meta.sequence; }
+            std::chrono::steady_clock::time_point captured() const { return slot_->meta.captured; }
+            void release();
+
+        private:
+            friend class FrameRing;
+            explicit Lease(Slot *slot) : slot_(slot) {}
+
+            Slot *slot_ = nullptr;
+        };
+
+        // Per-reader cursor which remembers the last consumed sequence number
+        // and counts frames the reader never got to see.
+        class Consumer {
+        public:
+            explicit Consumer(FrameRing &ring) : ring_(ring) {}
+            Consumer(const Consumer &) = delete;
+            Consumer &operator=(const Consumer &) = delete;
+
+            // Returns lease on the latest frame if it is newer than the last one consumed.
+            Lease acquireLatest();
+            // Copies the latest frame into dst if it is newer than the last one consumed.
+            bool readLatest(Frame &dst);
+            // Sleeps until a frame newer than the last one consumed is published.
+            // Returns an empty lease only when the ring has been closed.
+            Lease waitLatest();
+
+            uint64_t lastSequence() const { return last_; }
+            uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+        private:
+            FrameRing &ring_;
+            uint64_t last_ = 0;
+            std::atomic_uint64_t dropped_ = 0;
+        };
+
+        // streamId is stamped into the metadata of every frame.
+        FrameRing(const FrameData &fdat, int type = CV_8UC3, size_t slotsCount = 4u, size_t streamId = 0u);
+        FrameRing(const FrameRing &) = delete;
+        FrameRing &operator=(const FrameRing &) = delete;
+
+        // Producer side. beginWrite() returns nullptr if there is no free slot,
+        // otherwise the slot must be finished with commitWrite() or abortWrite().
+        Frame *beginWrite();
+        // Returns the metadata the frame was published with. captured is when
+        // the camera handed the frame over, now if not given.
+        FrameMeta commitWrite();
+        FrameMeta commitWrite(std::chrono::steady_clock::time_point captured);
+        void abortWrite();
+        bool push(const Frame &frame);
+
+        Lease acquireLatest();
+        // Wakes up all waiting consumers, they won't wait anymore afterwards.
+        void close();
+        bool isClosed() const { return closed_.load(std::memory_order_acquire); }
+
+        uint64_t latestSequence() const { return published_.load(std::memory_order_acquire); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+        size_t capacity() const { return slotsCount_; }
+
+    private:
+        std::unique_ptr<Slot[]> slots_;
+        const size_t slotsCount_;
+        const size_t streamId_;
+        std::atomic_size_t latest_;
+        std::atomic_uint64_t published_ = 0;
+        std::atomic_uint64_t dropped_ = 0;
+        // Bumped on every publish and on close, consumers sleep on it (futex
+        // backed where available) so the producer never takes a lock.
+        std::atomic_uint32_t epoch_ = 0;
+        std::atomic_bool closed_ = false;
+        size_t writing_;
+        size_t cursor_ = 0;
+    };
+}